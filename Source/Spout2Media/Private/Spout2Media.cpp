@@ -4,11 +4,45 @@
 
 #include "IMediaModule.h"
 #include "Interfaces/IPluginManager.h"
+#include "Misc/CoreDelegates.h"
 
+#include "Spout2MediaLog.h"
 #include "Spout2MediaPlayer.h"
+#include "Spout2MediaStats.h"
+#include "SpoutD3D11On12Device.h"
+#include "SpoutSendThread.h"
+#include "SpoutSenderDiscovery.h"
 
 #define LOCTEXT_NAMESPACE "FSpout2MediaModule"
 
+DEFINE_STAT(STAT_Spout2Media_SamplePoolHits);
+DEFINE_STAT(STAT_Spout2Media_SamplePoolMisses);
+DEFINE_STAT(STAT_Spout2Media_SamplesAllocated);
+DEFINE_STAT(STAT_Spout2Media_SampleTextureMemory);
+DEFINE_STAT(STAT_Spout2Media_SkippedCopies);
+DEFINE_STAT(STAT_Spout2Media_ReceiveFramesDropped);
+DEFINE_STAT(STAT_Spout2Media_ReceiveCopy);
+DEFINE_STAT(STAT_Spout2Media_SyncWait);
+DEFINE_STAT(STAT_Spout2Media_SyncWakeLatency);
+DEFINE_STAT(STAT_Spout2Media_ClockDrift);
+DEFINE_STAT(STAT_Spout2Media_ClockPhaseError);
+DEFINE_STAT(STAT_Spout2Media_GenlockFramesDropped);
+DEFINE_STAT(STAT_Spout2Media_GenlockFramesRepeated);
+DEFINE_STAT(STAT_Spout2Media_SyncGroupWait);
+DEFINE_STAT(STAT_Spout2Media_SyncGroupSetsReleased);
+DEFINE_STAT(STAT_Spout2Media_SyncGroupFramesDiscarded);
+DEFINE_STAT(STAT_Spout2Media_DiscoveryScans);
+DEFINE_STAT(STAT_Spout2Media_CaptureFrame);
+DEFINE_STAT(STAT_Spout2Media_SendCopy);
+DEFINE_STAT(STAT_Spout2Media_SendFramesDropped);
+DEFINE_STAT(STAT_Spout2Media_SendDeadlinesMissed);
+DEFINE_STAT(STAT_Spout2Media_SendJitter);
+DEFINE_STAT(STAT_Spout2Media_WrappedResources);
+DEFINE_STAT(STAT_Spout2Media_WrappedResourceHits);
+DEFINE_STAT(STAT_Spout2Media_WrappedResourceMisses);
+
+DEFINE_LOG_CATEGORY(LogSpout2Media);
+
 void FSpout2MediaModule::StartupModule()
 {
 	SupportedPlatforms.Add(TEXT("Windows"));
@@ -19,10 +53,24 @@ void FSpout2MediaModule::StartupModule()
 	{
 		MediaModule->RegisterPlayerFactory(*this);
 	}
+
+	// One submission per frame for the copies of every stream sharing the D3D11On12 device
+	EndFrameRTHandle = FCoreDelegates::OnEndFrameRT.AddStatic(&FSpoutD3D11On12Device::FlushRequested);
+
+	SenderDiscovery = MakeShared<FSpoutSenderDiscovery, ESPMode::ThreadSafe>();
 }
 
 void FSpout2MediaModule::ShutdownModule()
 {
+	FCoreDelegates::OnEndFrameRT.Remove(EndFrameRTHandle);
+	FSpoutSendThread::Shutdown();
+	SenderDiscovery.Reset();
+}
+
+FSpoutSenderDiscovery* FSpout2MediaModule::GetSenderDiscovery()
+{
+	FSpout2MediaModule* Module = FModuleManager::GetModulePtr<FSpout2MediaModule>("Spout2Media");
+	return Module ? Module->SenderDiscovery.Get() : nullptr;
 }
 
 bool FSpout2MediaModule::CanPlayUrl(const FString& Url, const IMediaOptions*, TArray<FText>*,
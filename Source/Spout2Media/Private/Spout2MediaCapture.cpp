@@ -1,55 +1,172 @@
 ﻿// Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Spout2MediaCapture.h"
+#include "Spout2MediaLog.h"
 #include "Spout2MediaOutput.h"
+#include "Spout2MediaStats.h"
+#include "SpoutCopyFence.h"
+#include "SpoutD3D11On12Device.h"
+#include "SpoutFramePacer.h"
 #include "SpoutFrameSyncHelper.h"
+#include "SpoutSendThread.h"
+#include "SpoutSenderDirectoryMapping.h"
+#include "SpoutSharedBuffers.h"
+#include "SpoutTransportRegistry.h"
+#include "GlobalShader.h"
+#include "ID3D11DynamicRHI.h"
+#include "MediaShaders.h"
+#include "RenderGraphBuilder.h"
+#include "RenderGraphUtils.h"
 #include "RenderingThread.h"
 #include "RHICommandList.h"
+#include "RHIGPUReadback.h"
+#include "ScreenPass.h"
 
 #include "Windows/AllowWindowsPlatformTypes.h" 
 #include <d3d11on12.h>
 #include "Spout.h"
 #include "Windows/HideWindowsPlatformTypes.h"
 
+#include <atomic>
+#include <chrono>
+
+namespace
+{
+	// Typed format the shared texture gets for a capture pixel format, receivers expect typed formats.
+	// FSpoutReceiverContext maps each of them back to a pixel format, keep the two in step.
+	DXGI_FORMAT GetSharedTextureFormat(EPixelFormat PixelFormat)
+	{
+		switch (PixelFormat)
+		{
+		case PF_B8G8R8A8:
+			return DXGI_FORMAT_B8G8R8A8_UNORM;
+		case PF_R8G8B8A8:
+			return DXGI_FORMAT_R8G8B8A8_UNORM;
+		case PF_A2B10G10R10:
+			return DXGI_FORMAT_R10G10B10A2_UNORM;
+		case PF_FloatRGBA:
+			return DXGI_FORMAT_R16G16B16A16_FLOAT;
+		case PF_A32B32G32R32F:
+			return DXGI_FORMAT_R32G32B32A32_FLOAT;
+		default:
+			return DXGI_FORMAT_UNKNOWN;
+		}
+	}
+}
+
+/**
+ * One Spout sender. The render thread records each frame's copy (or the zero-copy capture pass) and
+ * hands the frame to FSpoutSendThread, which submits the D3D11On12 copy and tells receivers about it.
+ */
 struct USpout2MediaCapture::FSpoutSenderContext
+	: public ISpoutSendTarget
+	, public TSharedFromThis<FSpoutSenderContext, ESPMode::ThreadSafe>
 {
 	FString SenderName;
 	uint32 Width, Height;
 	EPixelFormat PixelFormat;
 
+	// Format of the shared textures, announced to receivers
+	DXGI_FORMAT SharedFormat = DXGI_FORMAT_UNKNOWN;
+
+	// RHI the context was created for, D3D11 or D3D12
+	ERHIInterfaceType RHIType;
+
 	std::string SenderName_str;
 
 	ID3D11DeviceContext* DeviceContext = nullptr;
 	ID3D11Device* D3D11Device = nullptr;
 	
+	// Shared on D3D12 with every other sender and receiver, owns D3D11Device and D3D11on12Device
+	TSharedPtr<FSpoutD3D11On12Device, ESPMode::ThreadSafe> SharedDevice;
 	ID3D11On12Device* D3D11on12Device = nullptr;
-	TMap<FTextureRHIRef, ID3D11Resource*> WrappedDX11ResourceMap;
+
+	// 11on12 views of the send slots' staging textures, rewrapped when a capture resize recreates them
+	FSpoutWrappedResourceCache WrappedResources;
 
 	spoutSenderNames senders;
 	spoutDirectX sdx;
 
-	ID3D11Texture2D* SendingTexture = nullptr;
-	HANDLE SharedSendingHandle = nullptr;
+	// Publishes the frame counter receivers use to detect new frames
+	spoutFrameCount FrameCount;
+
+	// Frames handed to the send thread and not published yet. Slots are used in order,
+	// NextSendSlot on the render thread and NumPendingSends by both threads.
+	struct FSendSlot
+	{
+		// Written on the render thread after the copy into the staging texture (D3D12) or the shared texture
+		FSpoutCopyFence RenderFence;
+
+		// 11on12 copy the send thread submitted, D3D12 only
+		FSpoutCopyFence CopyFence;
+
+		// Copy of the capture made on the render thread, which the send thread copies from, D3D12 only.
+		// The capture texture itself goes back to the media capture pool before the send thread gets to it.
+		FTextureRHIRef StagingTexture;
+
+		// Shared texture the frame goes to
+		uint32 BufferIndex = 0;
+	};
+
+	static constexpr int32 MaxPendingSends = 4;
+	FSendSlot SendSlots[MaxPendingSends];
+	int32 NextSendSlot = 0;
+	std::atomic<int32> NumPendingSends{0};
+
+	// Signalled by the send thread when a copy completed, for waiting on D3D11 fences
+	HANDLE CopyCompletedEvent = nullptr;
 
-	// Frame rate control variables
-	FFrameRate TargetFrameRate;
-	double LastFrameTime;
-	double FrameInterval;  // Time between frames in seconds
+	// The capture's sync channel, referenced so the send thread can signal it after the capture stopped
+	TSharedPtr<FSpoutFrameSyncChannel, ESPMode::ThreadSafe> FrameSyncChannel;
+
+	// Number of the last published frame, the sequence of the buffer index when multi-buffered
+	uint64 LastPublishedFrame = 0;
+
+	// Texture shared with receivers. Zero-copy mode renders the capture into RHITexture, an RHI texture around it.
+	struct FSharedBuffer
+	{
+		ID3D11Texture2D* Texture = nullptr;
+		HANDLE Handle = nullptr;
+		FTextureRHIRef RHITexture;
+	};
+
+	// One buffer the usual Spout way, or several with the latest complete one published in BufferMapping
+	FSharedBuffer Buffers[SpoutBufferIndex::MaxBuffers];
+	uint32 NumBuffers;
+	FSpoutSharedBufferMapping BufferMapping;
+	TUniquePtr<SpoutBufferIndex::FWriter> BufferWriter;
+
+	bool bZeroCopy;
+
+	// Frame rate control, a zero numerator sends every captured frame
+	FFrameRate TargetFrameRate = FFrameRate(0, 1);
+	FSpoutFramePacer Pacer;
 
 	FSpoutSenderContext(const FString& SenderName,
 		uint32 Width, uint32 Height, EPixelFormat PixelFormat,
-		FTextureRHIRef InTexture)
+		FTextureRHIRef InTexture, bool bZeroCopy, int32 NumBuffers)
 		: SenderName(SenderName)
 		, Width(Width)
 		, Height(Height)
 		, PixelFormat(PixelFormat)
-		, LastFrameTime(0.0)
-		, FrameInterval(1.0/60.0) // Default to 60fps
+		, RHIType(RHIGetInterfaceType())
+		, NumBuffers(FMath::Clamp<int32>(NumBuffers, 1, SpoutBufferIndex::MaxBuffers))
+		, bZeroCopy(bZeroCopy)
 	{
 		SenderName_str = TCHAR_TO_ANSI(*SenderName);
 		InitSpout(InTexture);
 	}
 
+	// Whether the capture pass writes the shared texture directly
+	bool IsZeroCopy() const { return Buffers[0].RHITexture.IsValid(); }
+
+	// Zero-copy is possible on D3D11 for the formats receivers understand
+	static bool CanZeroCopy(EPixelFormat PixelFormat)
+	{
+		return RHIGetInterfaceType() == ERHIInterfaceType::D3D11
+			&& GetSharedTextureFormat(PixelFormat) != DXGI_FORMAT_UNKNOWN;
+	}
+
 	~FSpoutSenderContext()
 	{
 		DisposeSpout();
@@ -57,104 +174,136 @@ struct USpout2MediaCapture::FSpoutSenderContext
 
 	void InitSpout(FTextureRHIRef InTexture)
 	{
-		const FString RHIName = GDynamicRHI->GetName();
-
-		if (RHIName == TEXT("D3D11"))
+		if (RHIType == ERHIInterfaceType::D3D11)
 		{
 			D3D11Device = static_cast<ID3D11Device*>(GDynamicRHI->RHIGetNativeDevice());
 			D3D11Device->GetImmediateContext(&DeviceContext);
 		}
-		else if (RHIName == TEXT("D3D12"))
+		else if (RHIType == ERHIInterfaceType::D3D12)
 		{
-			ID3D12Device* Device12 = static_cast<ID3D12Device*>(GDynamicRHI->RHIGetNativeDevice());
-			UINT DeviceFlags11 = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
-
-			verify(D3D11On12CreateDevice(
-				Device12,
-				DeviceFlags11,
-				nullptr,
-				0,
-				nullptr,
-				0,
-				0,
-				&D3D11Device,
-				&DeviceContext,
-				nullptr
-			) == S_OK);
-
-			verify(D3D11Device->QueryInterface(__uuidof(ID3D11On12Device), (void**)&D3D11on12Device) == S_OK);
+			SharedDevice = FSpoutD3D11On12Device::Get();
+			D3D11Device = SharedDevice->GetDevice();
+			D3D11on12Device = SharedDevice->GetOn12Device();
+
+			// Referenced like the immediate context on D3D11, released in DisposeSpout
+			DeviceContext = SharedDevice->GetContext();
+			DeviceContext->AddRef();
 		}
 
-		ID3D12Resource* NativeTex = (ID3D12Resource*)InTexture->GetNativeResource();
-		D3D12_RESOURCE_DESC desc = NativeTex->GetDesc();
+		if (bZeroCopy)
+		{
+			check(CanZeroCopy(PixelFormat));
+			SharedFormat = GetSharedTextureFormat(PixelFormat);
+		}
+		else if (RHIType == ERHIInterfaceType::D3D11)
+		{
+			D3D11_TEXTURE2D_DESC Desc;
+			static_cast<ID3D11Texture2D*>(InTexture->GetNativeResource())->GetDesc(&Desc);
+			SharedFormat = Desc.Format;
+		}
+		else if (RHIType == ERHIInterfaceType::D3D12)
+		{
+			SharedFormat = static_cast<ID3D12Resource*>(InTexture->GetNativeResource())->GetDesc().Format;
+		}
 		
-		verify(senders.CreateSender(SenderName_str.c_str(), Width, Height, SharedSendingHandle, desc.Format));
-		verify(sdx.CreateSharedDX11Texture(D3D11Device, Width, Height, desc.Format, &SendingTexture, SharedSendingHandle));
+		verify(senders.CreateSender(SenderName_str.c_str(), Width, Height, Buffers[0].Handle, SharedFormat));
+
+		// Without the mapping receivers cannot tell the buffers apart, send the usual way
+		if (NumBuffers > 1 && !BufferMapping.Create(SenderName_str, NumBuffers))
+		{
+			NumBuffers = 1;
+		}
+
+		for (uint32 Index = 0; Index < NumBuffers; Index++)
+		{
+			FSharedBuffer& Buffer = Buffers[Index];
+			verify(sdx.CreateSharedDX11Texture(D3D11Device, Width, Height, SharedFormat, &Buffer.Texture, Buffer.Handle));
+
+			if (bZeroCopy)
+			{
+				Buffer.RHITexture = GetID3D11DynamicRHI()->RHICreateTexture2DFromResource(
+					PixelFormat, ETextureCreateFlags::RenderTargetable | ETextureCreateFlags::Shared, FClearValueBinding::None, Buffer.Texture);
+			}
+		}
+
+		if (BufferMapping.IsOpen())
+		{
+			SpoutBufferIndex::FLayout& Layout = BufferMapping.GetLayout();
+			for (uint32 Index = 0; Index < NumBuffers; Index++)
+			{
+				// Spout shares 32-bit handle values between processes
+				Layout.Handles[Index] = static_cast<uint32>(reinterpret_cast<UPTRINT>(Buffers[Index].Handle));
+			}
+
+			SpoutBufferIndex::Publish(Layout);
+			BufferWriter = MakeUnique<SpoutBufferIndex::FWriter>(Layout);
+		}
+
+		FrameCount.EnableFrameCount(SenderName_str.c_str());
+
+		CopyCompletedEvent = CreateEventA(NULL, false, false, NULL);
 	}
 
 	void DisposeSpout()
 	{
-		if (SendingTexture)
-		{
-			SendingTexture->Release();
-			SendingTexture = nullptr;
-		}
+		FrameCount.CleanupFrameCount();
 
-		if (DeviceContext)
+		if (CopyCompletedEvent)
 		{
-			DeviceContext->Release();
-			DeviceContext = nullptr;
+			CloseHandle(CopyCompletedEvent);
+			CopyCompletedEvent = nullptr;
 		}
 
+		BufferWriter.Reset();
+		BufferMapping.Close();
+
+		for (FSharedBuffer& Buffer : Buffers)
 		{
-			for (auto Iter : WrappedDX11ResourceMap)
+			// Deferred by the RHI, holds its own reference to the texture
+			Buffer.RHITexture.SafeRelease();
+
+			if (Buffer.Texture)
 			{
-				D3D11on12Device->ReleaseWrappedResources(&Iter.Value, 1);
+				Buffer.Texture->Release();
+				Buffer.Texture = nullptr;
 			}
-			WrappedDX11ResourceMap.Reset();
+
+			Buffer.Handle = nullptr;
 		}
 
-		if (D3D11on12Device)
+		if (DeviceContext)
 		{
-			D3D11on12Device->Release();
-			D3D11on12Device = nullptr;
+			DeviceContext->Release();
+			DeviceContext = nullptr;
 		}
 
-		if (D3D11Device)
+		WrappedResources.Reset();
+
+		for (FSendSlot& SendSlot : SendSlots)
 		{
-			D3D11Device->Release();
-			D3D11Device = nullptr;
+			SendSlot.StagingTexture.SafeRelease();
 		}
+
+		// Neither device is referenced by the context, the RHI or SharedDevice owns them
+		D3D11on12Device = nullptr;
+		D3D11Device = nullptr;
+		SharedDevice.Reset();
 	}
 
 	ID3D11Texture2D* GetTextureResource(FTextureRHIRef InTexture)
 	{
-		const FString RHIName = GDynamicRHI->GetName();
-		
-		if (RHIName == TEXT("D3D11"))
+		if (RHIType == ERHIInterfaceType::D3D11)
 		{
 			return static_cast<ID3D11Texture2D*>(InTexture->GetNativeResource());
 		}
-		else if (RHIName == TEXT("D3D12"))
+		else if (RHIType == ERHIInterfaceType::D3D12)
 		{
-			if (auto Iter = WrappedDX11ResourceMap.Find(InTexture))
-				return static_cast<ID3D11Texture2D*>(*Iter);
-
-			ID3D12Resource* NativeTex = static_cast<ID3D12Resource*>(InTexture->GetNativeResource());
-			ID3D11Resource* WrappedDX11Resource = nullptr;
-			
-			D3D11_RESOURCE_FLAGS rf11 = {};
-			verify(D3D11on12Device->CreateWrappedResource(
-				NativeTex, &rf11,
-				D3D12_RESOURCE_STATE_COPY_SOURCE,
-				D3D12_RESOURCE_STATE_PRESENT, __uuidof(ID3D11Resource),
-				(void**)&WrappedDX11Resource) == S_OK);
-
-			NativeTex->Release();
+			// Render targets the capture released are dropped before they count against the bound
+			WrappedResources.EvictReleased();
 
-			WrappedDX11ResourceMap.Add(InTexture, WrappedDX11Resource);
-
-			return static_cast<ID3D11Texture2D*>(WrappedDX11Resource);
+			return static_cast<ID3D11Texture2D*>(WrappedResources.FindOrWrap(D3D11on12Device, InTexture,
+				D3D12_RESOURCE_STATE_COPY_SOURCE,
+				D3D12_RESOURCE_STATE_PRESENT));
 		}
 		
 		return nullptr;
@@ -163,41 +312,388 @@ struct USpout2MediaCapture::FSpoutSenderContext
 	void SetFrameRate(const FFrameRate& InFrameRate)
 	{
 		TargetFrameRate = InFrameRate;
-		// Calculate frame interval in seconds
-		FrameInterval = (double)TargetFrameRate.Denominator / (double)TargetFrameRate.Numerator;
+		Pacer.SetFrameRate(TargetFrameRate.Numerator, TargetFrameRate.Denominator);
 	}
-    
+
+	// Whether the next frame's deadline passed. Polled by the render thread, which cannot wait,
+	// so the jitter also includes how long after the deadline the capture came in.
 	bool ShouldSendFrame()
 	{
-		double CurrentTime = FPlatformTime::Seconds();
-		bool bShouldSend = (CurrentTime - LastFrameTime) >= FrameInterval;
-        
-		if (bShouldSend)
+		if (!Pacer.IsFrameDue())
+			return false;
+
+		SET_FLOAT_STAT(STAT_Spout2Media_SendJitter, Pacer.GetJitterStats().Last.count() / 1e6);
+		INC_DWORD_STAT_BY(STAT_Spout2Media_SendDeadlinesMissed, Pacer.GetLastMissedFrames());
+		return true;
+	}
+
+	void SetFrameSyncChannel(const TSharedPtr<FSpoutFrameSyncChannel, ESPMode::ThreadSafe>& InFrameSyncChannel)
+	{
+		FrameSyncChannel = InFrameSyncChannel;
+	}
+
+	// Slot of the next send, INDEX_NONE when it is not time to send, too many sends are in flight
+	// or every shared buffer is in use
+	int32 BeginSend()
+	{
+		// Only process the frame if it's time to send a new one
+		if (!ShouldSendFrame())
+			return INDEX_NONE;
+
+		if (NumPendingSends.load() == MaxPendingSends)
 		{
-			LastFrameTime = CurrentTime;
+			INC_DWORD_STAT(STAT_Spout2Media_SendFramesDropped);
+			return INDEX_NONE;
 		}
-        
-		return bShouldSend;
+
+		uint32 BufferIndex = 0;
+		if (BufferWriter)
+		{
+			// Never the buffer receivers may be reading, nor one still being written
+			BufferIndex = BufferWriter->BeginWrite();
+			if (BufferIndex == SpoutBufferIndex::NoBuffer)
+			{
+				INC_DWORD_STAT(STAT_Spout2Media_SendFramesDropped);
+				return INDEX_NONE;
+			}
+		}
+
+		SendSlots[NextSendSlot].BufferIndex = BufferIndex;
+		return NextSendSlot;
 	}
 
-	void Tick_RenderThread(FTextureRHIRef InTexture)
+	// Hands the frame recorded in Slot to the send thread
+	void EndSend(int32 Slot)
 	{
-		const FString RHIName = GDynamicRHI->GetName();
+		NumPendingSends++;
 
+		if (!FSpoutSendThread::Get().Enqueue(AsShared(), Slot))
+		{
+			NumPendingSends--;
+
+			if (BufferWriter)
+			{
+				BufferWriter->AbortWrite(SendSlots[Slot].BufferIndex);
+			}
+
+			INC_DWORD_STAT(STAT_Spout2Media_SendFramesDropped);
+			return;
+		}
+
+		NextSendSlot = (NextSendSlot + 1) % MaxPendingSends;
+	}
+
+	void Tick_RenderThread(FTextureRHIRef InTexture)
+	{
 		if (!DeviceContext)
 			return;
 
-		// Only process the frame if it's time to send a new one
-		if (!ShouldSendFrame())
+		const int32 Slot = BeginSend();
+		if (Slot == INDEX_NONE)
 			return;
 
-		auto Texture = GetTextureResource(InTexture);
-		DeviceContext->CopyResource(SendingTexture, Texture);
+		SCOPE_CYCLE_COUNTER(STAT_Spout2Media_SendCopy);
+
+		FSendSlot& SendSlot = SendSlots[Slot];
+		FRHICommandListImmediate& RHICmdList = FRHICommandListExecutor::GetImmediateCommandList();
+
+		if (RHIType == ERHIInterfaceType::D3D11)
+		{
+			// The immediate context belongs to the RHI, so copy on the RHI thread in order with its own work
+			RHICmdList.EnqueueLambda([
+				DeviceContext = TRefCountPtr<ID3D11DeviceContext>(DeviceContext),
+				SendingTexture = TRefCountPtr<ID3D11Texture2D>(Buffers[SendSlot.BufferIndex].Texture),
+				Texture = TRefCountPtr<ID3D11Texture2D>(static_cast<ID3D11Texture2D*>(InTexture->GetNativeResource())),
+				InTexture](FRHICommandListImmediate&)
+			{
+				DeviceContext->CopyResource(SendingTexture, Texture);
+			});
+		}
+		else if (RHIType == ERHIInterfaceType::D3D12)
+		{
+			// The slot is not in flight, so its staging texture is free to take the frame
+			const FRHITextureDesc& Desc = InTexture->GetDesc();
+			if (!SendSlot.StagingTexture || SendSlot.StagingTexture->GetDesc().Extent != Desc.Extent
+				|| SendSlot.StagingTexture->GetDesc().Format != Desc.Format)
+			{
+				SendSlot.StagingTexture = RHICreateTexture(
+					FRHITextureCreateDesc::Create2D(TEXT("SpoutSendStaging"), Desc.Extent, Desc.Format));
+			}
+
+			RHICmdList.Transition({
+				FRHITransitionInfo(InTexture, ERHIAccess::Unknown, ERHIAccess::CopySrc),
+				FRHITransitionInfo(SendSlot.StagingTexture, ERHIAccess::Unknown, ERHIAccess::CopyDest)
+			});
+
+			// Copied on to the shared texture by the send thread once the GPU executed this
+			RHICmdList.CopyTexture(InTexture, SendSlot.StagingTexture, FRHICopyTextureInfo());
+
+			RHICmdList.Transition(FRHITransitionInfo(SendSlot.StagingTexture, ERHIAccess::CopyDest, ERHIAccess::CopySrc));
+		}
+
+		SendSlot.RenderFence.WriteRHI(RHICmdList);
+		EndSend(Slot);
+	}
+
+	// Zero-copy counterpart of Tick_RenderThread, adds the capture pass writing the shared texture
+	void Capture_RenderThread(FRDGBuilder& GraphBuilder, FRDGTextureRef SourceTexture, const FRHICopyTextureInfo& CopyInfo)
+	{
+		if (!IsZeroCopy())
+			return;
+
+		const int32 Slot = BeginSend();
+		if (Slot == INDEX_NONE)
+			return;
+
+		FRDGTextureRef SharedTexture = GraphBuilder.RegisterExternalTexture(
+			CreateRenderTarget(Buffers[SendSlots[Slot].BufferIndex].RHITexture, TEXT("SpoutSharedTexture")));
+
+		FRHICopyTextureInfo SharedCopyInfo = CopyInfo;
+		SharedCopyInfo.DestPosition = FIntVector::ZeroValue;
+		AddCopyTexturePass(GraphBuilder, SourceTexture, SharedTexture, SharedCopyInfo);
+
+		// Written once the pass above executed, receivers are told about the frame when it passed
+		GraphBuilder.AddPass(
+			RDG_EVENT_NAME("SpoutSendFence"),
+			ERDGPassFlags::NeverCull,
+			[Fence = FGPUFenceRHIRef(SendSlots[Slot].RenderFence.BeginRHI())](FRHICommandListImmediate& RHICmdList)
+			{
+				RHICmdList.WriteGPUFence(Fence);
+			});
+
+		EndSend(Slot);
+	}
+
+	//~ ISpoutSendTarget interface
+	virtual bool IsRenderComplete_SendThread(int32 Slot) const override
+	{
+		return SendSlots[Slot].RenderFence.IsComplete();
+	}
+
+	virtual bool Submit_SendThread(int32 Slot) override
+	{
+		// D3D11 and zero-copy frames were written on the RHI, there is nothing left to submit
+		FSendSlot& SendSlot = SendSlots[Slot];
+		if (!SendSlot.StagingTexture)
+			return true;
+
+		// The context is shared with every other stream on the 11on12 device
+		FScopeLock Lock(&SharedDevice->GetContextLock());
+
+		auto Texture = GetTextureResource(SendSlot.StagingTexture);
+		if (!Texture)
+			return false;
+
+		ID3D11Resource* WrappedDX11Resource = Texture;
+		D3D11on12Device->AcquireWrappedResources(&WrappedDX11Resource, 1);
+		DeviceContext->CopyResource(Buffers[SendSlot.BufferIndex].Texture, Texture);
+		D3D11on12Device->ReleaseWrappedResources(&WrappedDX11Resource, 1);
+		SharedDevice->GetFenceSource().Signal(SendSlot.CopyFence);
+
+		// Already off the render thread, so submit right away
 		DeviceContext->Flush();
-		
+		return true;
+	}
+
+	virtual bool WaitForSubmit_SendThread(int32 Slot, uint32 TimeoutMs) override
+	{
+		const FSpoutCopyFence& CopyFence = SendSlots[Slot].CopyFence;
+		if (!CopyFence.D3D11Fence || CopyFence.IsComplete())
+			return true;
+
+		CopyFence.D3D11Fence->SetEventOnCompletion(CopyFence.D3D11FenceValue, CopyCompletedEvent);
+		return WaitForSingleObject(CopyCompletedEvent, TimeoutMs) == WAIT_OBJECT_0 || CopyFence.IsComplete();
+	}
+
+	virtual void Publish_SendThread(int32 Slot) override
+	{
+		FSendSlot& SendSlot = SendSlots[Slot];
+		SendSlot.CopyFence.Reset();
+
+		if (BufferWriter)
+		{
+			LastPublishedFrame = BufferWriter->EndWrite(SendSlot.BufferIndex);
+		}
+		else
+		{
+			LastPublishedFrame++;
+		}
+
+		// Multi-buffered senders point the sender info at the latest buffer, receivers unaware
+		// of the mapping reopen it on each frame but still read complete frames
 		verify(senders.UpdateSender(SenderName_str.c_str(),
 			Width, Height,
-			SharedSendingHandle));
+			Buffers[SendSlot.BufferIndex].Handle));
+
+		FrameCount.SetNewFrame();
+
+		// Signal frame sync once a frame reached receivers - this is the key part that links
+		// Unreal's rendering with the Spout sync
+		if (FrameSyncChannel)
+		{
+			FrameSyncChannel->Signal(LastPublishedFrame);
+		}
+
+		NumPendingSends--;
+	}
+
+	virtual void Drop_SendThread(int32 Slot) override
+	{
+		FSendSlot& SendSlot = SendSlots[Slot];
+		SendSlot.CopyFence.Reset();
+
+		// The buffer keeps what it held, receivers go on reading the last published frame
+		if (BufferWriter)
+		{
+			BufferWriter->AbortWrite(SendSlot.BufferIndex);
+		}
+
+		INC_DWORD_STAT(STAT_Spout2Media_SendFramesDropped);
+		NumPendingSends--;
+	}
+};
+
+/**
+ * Sender of a CPU frame transport, see SpoutTransport. The render thread enqueues a readback of each sent
+ * frame and, on later frames, writes the readbacks that landed into the transport. No Spout sender is
+ * created, receivers find the sender through the transport by name.
+ */
+struct USpout2MediaCapture::FSpoutTransportSenderContext
+{
+	uint32 Width, Height;
+	EPixelFormat PixelFormat;
+
+	std::unique_ptr<SpoutTransport::ISender> Sender;
+
+	// Readbacks in flight, oldest at FirstReadback. Frames are dropped while all of them are.
+	struct FReadback
+	{
+		TUniquePtr<FRHIGPUTextureReadback> Readback;
+		int64 TimestampNs = 0;
+	};
+
+	static constexpr int32 NumReadbacks = 3;
+	FReadback Readbacks[NumReadbacks];
+	int32 FirstReadback = 0;
+	int32 NumPendingReadbacks = 0;
+
+	// The capture's sync channel, referenced so a frame published after the capture stopped can still signal it
+	TSharedPtr<FSpoutFrameSyncChannel, ESPMode::ThreadSafe> FrameSyncChannel;
+
+	// Frame rate control, a zero numerator sends every captured frame
+	FFrameRate TargetFrameRate = FFrameRate(0, 1);
+	FSpoutFramePacer Pacer;
+
+	FSpoutTransportSenderContext(SpoutTransport::ITransport& Transport, const FString& SenderName,
+		uint32 Width, uint32 Height, EPixelFormat PixelFormat)
+		: Width(Width)
+		, Height(Height)
+		, PixelFormat(PixelFormat)
+	{
+		Sender = Transport.CreateSender(TCHAR_TO_ANSI(*SenderName), static_cast<uint64>(GetRowBytes()) * Height);
+
+		for (FReadback& Readback : Readbacks)
+		{
+			Readback.Readback = MakeUnique<FRHIGPUTextureReadback>(TEXT("SpoutFrameReadback"));
+		}
+	}
+
+	~FSpoutTransportSenderContext()
+	{
+		Sender.reset();
+	}
+
+	uint32 GetRowBytes() const { return Width * GPixelFormats[PixelFormat].BlockBytes; }
+
+	void SetFrameRate(const FFrameRate& InFrameRate)
+	{
+		TargetFrameRate = InFrameRate;
+		Pacer.SetFrameRate(TargetFrameRate.Numerator, TargetFrameRate.Denominator);
+	}
+
+	void SetFrameSyncChannel(const TSharedPtr<FSpoutFrameSyncChannel, ESPMode::ThreadSafe>& InFrameSyncChannel)
+	{
+		FrameSyncChannel = InFrameSyncChannel;
+	}
+
+	// Writes the readbacks that landed into the transport, in capture order
+	void PublishCompletedReadbacks()
+	{
+		while (NumPendingReadbacks > 0)
+		{
+			FReadback& Readback = Readbacks[FirstReadback];
+			if (!Readback.Readback->IsReady())
+				return;
+
+			const uint32 RowBytes = GetRowBytes();
+
+			int32 RowPitchInPixels = 0;
+			const uint8* Source = static_cast<const uint8*>(Readback.Readback->Lock(RowPitchInPixels));
+			uint8* Dest = Source ? Sender->BeginFrame(RowBytes * Height) : nullptr;
+
+			if (Dest)
+			{
+				// Rows are packed in the transport, the readback pads them to its pitch
+				const uint32 SourcePitch = RowPitchInPixels * GPixelFormats[PixelFormat].BlockBytes;
+				for (uint32 Row = 0; Row < Height; Row++)
+				{
+					FMemory::Memcpy(Dest + Row * RowBytes, Source + Row * SourcePitch, RowBytes);
+				}
+
+				SpoutTransport::FFrameInfo Info;
+				Info.TimestampNs = Readback.TimestampNs;
+				Info.Width = Width;
+				Info.Height = Height;
+				Info.Stride = RowBytes;
+				Info.PixelFormat = PixelFormat;
+				Info.Size = RowBytes * Height;
+				const uint64 FrameNumber = Sender->EndFrame(Info);
+
+				if (FrameSyncChannel)
+				{
+					FrameSyncChannel->Signal(FrameNumber);
+				}
+			}
+			else
+			{
+				INC_DWORD_STAT(STAT_Spout2Media_SendFramesDropped);
+			}
+
+			Readback.Readback->Unlock();
+
+			FirstReadback = (FirstReadback + 1) % NumReadbacks;
+			NumPendingReadbacks--;
+		}
+	}
+
+	void Tick_RenderThread(FRHICommandListImmediate& RHICmdList, FTextureRHIRef InTexture)
+	{
+		if (!Sender)
+			return;
+
+		PublishCompletedReadbacks();
+
+		if (!Pacer.IsFrameDue())
+			return;
+
+		SET_FLOAT_STAT(STAT_Spout2Media_SendJitter, Pacer.GetJitterStats().Last.count() / 1e6);
+		INC_DWORD_STAT_BY(STAT_Spout2Media_SendDeadlinesMissed, Pacer.GetLastMissedFrames());
+
+		if (NumPendingReadbacks == NumReadbacks)
+		{
+			INC_DWORD_STAT(STAT_Spout2Media_SendFramesDropped);
+			return;
+		}
+
+		SCOPE_CYCLE_COUNTER(STAT_Spout2Media_SendCopy);
+
+		FReadback& Readback = Readbacks[(FirstReadback + NumPendingReadbacks) % NumReadbacks];
+		Readback.TimestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+
+		RHICmdList.Transition(FRHITransitionInfo(InTexture, ERHIAccess::Unknown, ERHIAccess::CopySrc));
+		Readback.Readback->EnqueueCopy(RHICmdList, InTexture);
+		NumPendingReadbacks++;
 	}
 };
 
@@ -216,14 +712,20 @@ bool USpout2MediaCapture::HasFinishedProcessing() const
 
 void USpout2MediaCapture::SetFrameRate(int32 FramesPerSecond)
 {
-	if (FrameSyncHelper)
+	if (FramesPerSecond <= 0)
 	{
-		FrameSyncHelper->HoldFps(FramesPerSecond);
+		UE_LOG(LogSpout2Media, Warning, TEXT("SetFrameRate(%d) ignored, the frame rate must be positive. Use DisableFrameRateControl to stop pacing."), FramesPerSecond);
+		return;
 	}
+
+	// Picked up by the sender context with the next captured frame
+	OutputFrameRate = FFrameRate(FramesPerSecond, 1);
 }
 
 void USpout2MediaCapture::DisableFrameRateControl()
 {
+	bFrameRateControl = false;
+	
 	if (FrameSyncHelper)
 	{
 		FrameSyncHelper->DisableFrameCount();
@@ -232,11 +734,7 @@ void USpout2MediaCapture::DisableFrameRateControl()
 
 bool USpout2MediaCapture::IsFrameRateControlEnabled() const
 {
-	if (FrameSyncHelper)
-	{
-		return FrameSyncHelper->IsFrameCountEnabled();
-	}
-	return false;
+	return bFrameRateControl;
 }
 
 void USpout2MediaCapture::SignalFrameSync()
@@ -292,43 +790,145 @@ void USpout2MediaCapture::StopCaptureImpl(bool bAllowPendingFrameToBeProcess)
 void USpout2MediaCapture::OnRHIResourceCaptured_RenderingThread(const FCaptureBaseData& InBaseData,
 	TSharedPtr<FMediaCaptureUserData, ESPMode::ThreadSafe> InUserData, FTextureRHIRef InTexture)
 {
-	USpout2MediaOutput* Output = CastChecked<USpout2MediaOutput>(MediaOutput);
+	SCOPE_CYCLE_COUNTER(STAT_Spout2Media_CaptureFrame);
 	
-	// Use the modified sender name with embedded frame rate info
-	const FString SenderName = Output->GetModifiedSenderName();
 	auto InTexture2D = InTexture->GetTexture2D();
-	uint32 Width = InTexture2D->GetSizeX();
-	uint32 Height = InTexture2D->GetSizeY();
-	EPixelFormat PixelFormat = InTexture2D->GetFormat();
+	
+	if (Transport != ESpout2MediaTransport::SharedTexture)
+	{
+		UpdateTransportContext(InTexture2D->GetSizeX(), InTexture2D->GetSizeY(), InTexture2D->GetFormat());
+		TransportContext->Tick_RenderThread(FRHICommandListExecutor::GetImmediateCommandList(), InTexture);
+		return;
+	}
+	
+	// Already sent by the custom capture pass
+	if (Context && Context->bZeroCopy)
+		return;
+	
+	UpdateContext(InTexture2D->GetSizeX(), InTexture2D->GetSizeY(), InTexture2D->GetFormat(), InTexture, false);
+
+	// The send thread signals frame sync once the frame reached receivers
+	if (Context)
+	{
+		Context->Tick_RenderThread(InTexture);
+	}
+}
 
+void USpout2MediaCapture::OnCustomCapture_RenderingThread(FRDGBuilder& GraphBuilder, const FCaptureBaseData& InBaseData,
+	TSharedPtr<FMediaCaptureUserData, ESPMode::ThreadSafe> InUserData, FRDGTextureRef InSourceTexture, FRDGTextureRef OutputTexture,
+	const FRHICopyTextureInfo& CopyInfo, FVector2D CropU, FVector2D CropV)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Spout2Media_CaptureFrame);
+	
+	const EPixelFormat PixelFormat = InSourceTexture->Desc.Format;
+	
+	// Without zero-copy support, capture as usual and let OnRHIResourceCaptured_RenderingThread copy.
+	// Other transports read the captured frame back, there is no shared texture to render into.
+	if (!bZeroCopy || Transport != ESpout2MediaTransport::SharedTexture || !FSpoutSenderContext::CanZeroCopy(PixelFormat))
+	{
+		if (Context && Context->bZeroCopy)
+			Context.Reset();
+		
+		// A copy needs the same format and size on both sides, the output has the requested ones
+		if (OutputTexture->Desc.Format == PixelFormat && OutputTexture->Desc.Extent == FIntPoint(CopyInfo.Size.X, CopyInfo.Size.Y))
+		{
+			AddCopyTexturePass(GraphBuilder, InSourceTexture, OutputTexture, CopyInfo);
+			return;
+		}
+		
+		// Otherwise resample it the way UMediaCapture converts, without changing the channels
+		FGlobalShaderMap* GlobalShaderMap = GetGlobalShaderMap(GMaxRHIFeatureLevel);
+		
+		FModifyAlphaSwizzleRgbaPS::FPermutationDomain PermutationVector;
+		PermutationVector.Set<FModifyAlphaSwizzleRgbaPS::FConversionOp>(0);
+		TShaderMapRef<FModifyAlphaSwizzleRgbaPS> PixelShader(GlobalShaderMap, PermutationVector);
+		TShaderMapRef<FScreenPassVS> VertexShader(GlobalShaderMap);
+		
+		FModifyAlphaSwizzleRgbaPS::FParameters* PassParameters = PixelShader->AllocateAndSetParameters(GraphBuilder, InSourceTexture, OutputTexture);
+		
+		AddDrawScreenPass(GraphBuilder, RDG_EVENT_NAME("SpoutCaptureResample"), FScreenPassViewInfo(),
+			FScreenPassTextureViewport(OutputTexture),
+			FScreenPassTextureViewport(InSourceTexture, CopyInfo.GetSourceRect()),
+			VertexShader, PixelShader, PassParameters);
+		return;
+	}
+	
+	UpdateContext(CopyInfo.Size.X, CopyInfo.Size.Y, PixelFormat, nullptr, true);
+	
+	Context->Capture_RenderThread(GraphBuilder, InSourceTexture, CopyInfo);
+}
+
+void USpout2MediaCapture::UpdateContext(uint32 Width, uint32 Height, EPixelFormat PixelFormat, FTextureRHIRef InTexture, bool bInZeroCopy)
+{
+	// The sender name only changes when the capture restarts, which drops the context
 	if (!Context
-		|| Context->SenderName != SenderName
 		|| Context->Width != Width
 		|| Context->Height != Height
-		|| Context->PixelFormat != PixelFormat)
+		|| Context->PixelFormat != PixelFormat
+		|| Context->bZeroCopy != bInZeroCopy)
 	{
 		if (Context)
 			Context.Reset();
 		
+		// Use the modified sender name with embedded frame rate info
 		Context = MakeShared<FSpoutSenderContext, ESPMode::ThreadSafe>(
-			SenderName, Width, Height, PixelFormat, InTexture);
+			ModifiedSenderName, Width, Height, PixelFormat, InTexture, bInZeroCopy, NumSharedTextures);
 		
-		// Set the frame rate on initialization
-		Context->SetFrameRate(OutputFrameRate);
+		Context->SetFrameSyncChannel(FrameSyncChannel);
+		
+		RegisterSender(Width, Height, Context->SharedFormat,
+			static_cast<uint32>(reinterpret_cast<UPTRINT>(Context->Buffers[0].Handle)));
 	}
+	
+	const FFrameRate PacedFrameRate = bFrameRateControl ? OutputFrameRate : FFrameRate(0, 1);
+	if (Context->TargetFrameRate != PacedFrameRate)
+	{
+		Context->SetFrameRate(PacedFrameRate);
+	}
+}
 
-	if (Context)
+void USpout2MediaCapture::UpdateTransportContext(uint32 Width, uint32 Height, EPixelFormat PixelFormat)
+{
+	if (!TransportContext
+		|| TransportContext->Width != Width
+		|| TransportContext->Height != Height
+		|| TransportContext->PixelFormat != PixelFormat)
 	{
-		Context->Tick_RenderThread(InTexture);
+		// Dropped before the new one publishes under the same name
+		TransportContext.Reset();
 		
-		// Signal frame sync after sending the frame - this is the key part that links
-		// Unreal's rendering with the Spout sync
-		if (FrameSyncHelper)
-		{
-			// We're already in the render thread so this is synchronized with the frame render
-			FrameSyncHelper->SetFrameSync(Output->SenderName);
-		}
+		TransportContext = MakeShared<FSpoutTransportSenderContext, ESPMode::ThreadSafe>(
+			*SpoutTransportRegistry::Get(Transport), BaseSenderName, Width, Height, PixelFormat);
+		TransportContext->SetFrameSyncChannel(FrameSyncChannel);
+		
+		RegisterSender(Width, Height, 0, 0);
 	}
+	
+	const FFrameRate PacedFrameRate = bFrameRateControl ? OutputFrameRate : FFrameRate(0, 1);
+	if (TransportContext->TargetFrameRate != PacedFrameRate)
+	{
+		TransportContext->SetFrameRate(PacedFrameRate);
+	}
+}
+
+void USpout2MediaCapture::RegisterSender(uint32 Width, uint32 Height, uint32 Format, uint32 ShareHandle)
+{
+	if (!DirectoryEntry)
+		return;
+	
+	// Keyed by the name without FPS information, a new size updates the entry receivers already resolved
+	SpoutSenderDirectory::FSenderInfo Info;
+	const FString& Name = Transport == ESpout2MediaTransport::SharedTexture ? ModifiedSenderName : BaseSenderName;
+	FCStringAnsi::Strncpy(Info.Name, StringCast<ANSICHAR>(*Name).Get(), SpoutSenderDirectory::MaxNameLength);
+	Info.Width = Width;
+	Info.Height = Height;
+	Info.Format = Format;
+	Info.ShareHandle = ShareHandle;
+	Info.FrameRateNumerator = OutputFrameRate.Numerator;
+	Info.FrameRateDenominator = OutputFrameRate.Denominator;
+	Info.Transport = static_cast<uint32>(Transport);
+	
+	DirectoryEntry->Register(Info);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -337,16 +937,26 @@ bool USpout2MediaCapture::InitSpout(USpout2MediaOutput* Output)
 {
 	// Store the output frame rate from media output
 	OutputFrameRate = Output->OutputFrameRate;
+	ModifiedSenderName = Output->GetModifiedSenderName();
+	bZeroCopy = Output->bZeroCopy;
+	NumSharedTextures = Output->NumSharedTextures;
+	Transport = Output->Transport;
+	BaseSenderName = Output->SenderName;
 	
 	// Get the link to render thread setting
 	bLinkToRenderThread = Output->bLinkToRenderThread;
 	
-	// Configure frame rate control
+	// Sends are paced by the sender context against OutputFrameRate
+	bFrameRateControl = Output->bEnableFrameRateControl;
+	
 	if (FrameSyncHelper)
 	{
-		FrameSyncHelper->HoldFps(OutputFrameRate.Numerator / OutputFrameRate.Denominator);
+		FrameSyncChannel = FrameSyncHelper->GetFrameSyncChannel(Output->SenderName);
 	}
 	
+	// Registered with the first frame, once the shared texture exists
+	DirectoryEntry = MakeShared<FSpoutSenderDirectoryEntry, ESPMode::ThreadSafe>();
+	
 	SetState(EMediaCaptureState::Capturing);
 	return true;
 }
@@ -361,8 +971,11 @@ bool USpout2MediaCapture::DisposeSpout()
 			FrameSyncHelper->ClearFrameSync(Output->SenderName);
 		}
 	}
+	FrameSyncChannel.Reset();
 	
 	SetState(EMediaCaptureState::Stopped);
 	Context.Reset();
+	TransportContext.Reset();
+	DirectoryEntry.Reset();
 	return true;
 }
\ No newline at end of file
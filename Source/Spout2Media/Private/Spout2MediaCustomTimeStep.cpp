@@ -3,6 +3,33 @@
 #include "Spout2MediaCustomTimeStep.h"
 #include "MediaPlayerFacade.h"
 
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include "Spout.h"
+#include "Windows/HideWindowsPlatformTypes.h"
+
+#include "Spout2MediaStats.h"
+#include "SpoutClockRecovery.h"
+
+namespace
+{
+	// Sleeps while the OS timer is coarse enough, then spins
+	void WaitUntil(double Time)
+	{
+		for (double Now = FPlatformTime::Seconds(); Now < Time; Now = FPlatformTime::Seconds())
+		{
+			const double Remaining = Time - Now;
+			if (Remaining > 0.002)
+			{
+				FPlatformProcess::SleepNoStats(static_cast<float>(Remaining - 0.002));
+			}
+			else
+			{
+				FPlatformProcess::YieldThread();
+			}
+		}
+	}
+}
+
 USpout2MediaCustomTimeStep::USpout2MediaCustomTimeStep(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -13,31 +40,153 @@ bool USpout2MediaCustomTimeStep::Initialize(UEngine* InEngine)
 	if (!MediaPlayer)
 		return false;
 	
+	CachedMediaPlayer = MediaPlayer.LoadSynchronous();
 	return true;
 }
 
 void USpout2MediaCustomTimeStep::Shutdown(UEngine* InEngine)
 {
+	ClockRecovery.Reset();
+	ClockRecoveryName = NAME_None;
+	SenderFrameCount.Reset();
+	SenderFrameCountName = NAME_None;
 	SpoutMediaPlayer.Reset();
+	CachedMediaPlayer = nullptr;
 }
 
-bool USpout2MediaCustomTimeStep::UpdateTimeStep(UEngine* InEngine)
+bool USpout2MediaCustomTimeStep::ResolvePlayer()
 {
-	auto PlayerAsset = MediaPlayer.LoadSynchronous();
-	if (PlayerAsset == nullptr)
-		return false;
+	// Kept while it plays, the facade only swaps players when the media player opens something else
+	if (SpoutMediaPlayer && SpoutMediaPlayer->IsHardwareReady())
+		return true;
+	
+	if (!CachedMediaPlayer)
+	{
+		CachedMediaPlayer = MediaPlayer.LoadSynchronous();
+		if (!CachedMediaPlayer)
+			return false;
+	}
 	
-	auto Player = StaticCastSharedPtr<FSpout2MediaPlayer>(PlayerAsset->GetPlayerFacade()->GetPlayer());
-	if (Player == nullptr || !Player.IsValid())
+	SpoutMediaPlayer = StaticCastSharedPtr<FSpout2MediaPlayer>(CachedMediaPlayer->GetPlayerFacade()->GetPlayer());
+	return SpoutMediaPlayer.IsValid();
+}
+
+bool USpout2MediaCustomTimeStep::UpdateTimeStep(UEngine* InEngine)
+{
+	if (!ResolvePlayer())
+	{
+		bLastSyncDataValid = false;
 		return false;
+	}
 
-	SpoutMediaPlayer = Player;
+	int64 PredictedSenderFrame = 0;
+	if (bClockRecovery && TickInPhase(PredictedSenderFrame))
+	{
+		UpdateSyncCount(PredictedSenderFrame, true);
+		return true;
+	}
 
 	const bool bWaitedForSync = WaitForSync();
+	UpdateSyncCount(0, bWaitedForSync);
 
 	return true;
 }
 
+bool USpout2MediaCustomTimeStep::TickInPhase(int64& OutPredictedSenderFrame)
+{
+	if (!SpoutMediaPlayer->IsHardwareReady())
+	{
+		ClockRecovery.Reset();
+		return false;
+	}
+
+	// Compared as names every tick, the string is only built when the sender changed
+	const FName SenderName = SpoutMediaPlayer->GetSubscribeName();
+	if (!ClockRecovery || ClockRecoveryName != SenderName)
+	{
+		ClockRecovery = MakeShared<FSpoutClockRecovery>(SenderName.ToString(), SpoutMediaPlayer->GetSourceName(),
+			SpoutMediaPlayer->GetFrameRate(), ClockRecoveryBandwidth);
+		ClockRecoveryName = SenderName;
+	}
+
+	const FSpoutClockRecovery::FEstimate Estimate = ClockRecovery->GetEstimate();
+	if (!Estimate.bLocked)
+		return false;
+
+	// The first predicted frame half a period after the previous tick, so no sender frame ticks twice.
+	// When the engine fell behind, tick right away on the latest frame instead.
+	double TickTime = Estimate.PredictArrivalAfter(LastTickTime + Estimate.Period * 0.5);
+	const double Now = FPlatformTime::Seconds();
+	if (TickTime < Now)
+	{
+		TickTime = Estimate.PredictArrivalAfter(Now) - Estimate.Period;
+	}
+
+	WaitUntil(TickTime);
+
+	OutPredictedSenderFrame = Estimate.PredictSenderFrame(TickTime);
+	LastTickTime = TickTime;
+	return true;
+}
+
+int64 USpout2MediaCustomTimeStep::ReadSenderFrame()
+{
+	const FName SenderName = SpoutMediaPlayer->GetSubscribeName();
+	if (!SenderFrameCount || SenderFrameCountName != SenderName)
+	{
+		SenderFrameCount = MakeShared<spoutFrameCount>();
+		SenderFrameCount->EnableFrameCount(TCHAR_TO_ANSI(*SenderName.ToString()));
+		SenderFrameCountName = SenderName;
+		LastSyncSenderFrame = 0;
+	}
+
+	// Refreshes the sender frame, whether it is new does not matter here
+	SenderFrameCount->GetNewFrame();
+	return FMath::Max<int64>(SenderFrameCount->GetSenderFrame(), 0);
+}
+
+void USpout2MediaCustomTimeStep::UpdateSyncCount(int64 PredictedSenderFrame, bool bSynced)
+{
+	// The sender's own counter when it keeps one, otherwise the clock recovery's prediction
+	int64 SenderFrame = ReadSenderFrame();
+	if (SenderFrame == 0)
+	{
+		SenderFrame = PredictedSenderFrame;
+	}
+
+	if (SenderFrame == 0)
+	{
+		// Nothing to count with, one frame per successful wait
+		LastSyncCountDelta = 1;
+		bLastSyncDataValid = bSynced;
+		return;
+	}
+
+	if (LastSyncSenderFrame == 0 || SenderFrame < LastSyncSenderFrame)
+	{
+		// First frame, or the sender restarted its count
+		LastSyncCountDelta = 1;
+	}
+	else
+	{
+		LastSyncCountDelta = static_cast<uint32>(SenderFrame - LastSyncSenderFrame);
+
+		// Ticked again on the same sender frame, or the engine could not keep up and skipped some
+		if (LastSyncCountDelta == 0)
+		{
+			INC_DWORD_STAT(STAT_Spout2Media_GenlockFramesRepeated);
+		}
+		else if (LastSyncCountDelta > 1)
+		{
+			INC_DWORD_STAT_BY(STAT_Spout2Media_GenlockFramesDropped, LastSyncCountDelta - 1);
+		}
+	}
+
+	// The counter keeps the frame count right, but a tick the wait timed out on was not locked to the sender
+	LastSyncSenderFrame = SenderFrame;
+	bLastSyncDataValid = bSynced;
+}
+
 ECustomTimeStepSynchronizationState USpout2MediaCustomTimeStep::GetSynchronizationState() const
 {
 	if (!SpoutMediaPlayer || !SpoutMediaPlayer->IsHardwareReady())
@@ -56,7 +205,7 @@ FFrameRate USpout2MediaCustomTimeStep::GetFixedFrameRate() const
 
 uint32 USpout2MediaCustomTimeStep::GetLastSyncCountDelta() const
 {
-	return 1;
+	return LastSyncCountDelta;
 }
 
 bool USpout2MediaCustomTimeStep::IsLastSyncDataValid() const
@@ -64,7 +213,15 @@ bool USpout2MediaCustomTimeStep::IsLastSyncDataValid() const
 	if (!SpoutMediaPlayer || !SpoutMediaPlayer->IsHardwareReady())
 		return false;
 
-	return true;
+	return bLastSyncDataValid;
+}
+
+float USpout2MediaCustomTimeStep::GetEstimatedDriftPpm() const
+{
+	if (!ClockRecovery)
+		return 0.0f;
+
+	return static_cast<float>(ClockRecovery->GetEstimate().DriftPpm);
 }
 
 bool USpout2MediaCustomTimeStep::WaitForSync()
@@ -28,7 +28,10 @@ EPixelFormat USpout2MediaOutput::GetRequestedPixelFormat() const
 
 EMediaCaptureConversionOperation USpout2MediaOutput::GetConversionOperation(EMediaCaptureSourceType InSourceType) const
 {
-	EMediaCaptureConversionOperation Result = EMediaCaptureConversionOperation::NONE;
+	// The custom capture pass renders into the shared texture, see USpout2MediaCapture
+	EMediaCaptureConversionOperation Result = bZeroCopy
+		? EMediaCaptureConversionOperation::CUSTOM
+		: EMediaCaptureConversionOperation::NONE;
 	return Result;
 }
 
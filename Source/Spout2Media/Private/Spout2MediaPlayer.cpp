@@ -2,6 +2,7 @@
 
 
 #include "Spout2MediaPlayer.h"
+#include "Spout2Media.h"
 
 #include "Windows/AllowWindowsPlatformTypes.h" 
 #include <d3d11on12.h>
@@ -11,95 +12,478 @@
 #include "RHICommandList.h"
 #include "MediaShaders.h"
 #include "RenderingThread.h"
+#include "TickableObjectRenderThread.h"
 
+#include "Spout2MediaLog.h"
+#include "Spout2MediaSampleQueue.h"
 #include "Spout2MediaTextureSample.h"
 #include "Spout2MediaSource.h"
+#include "Spout2MediaStats.h"
+#include "Spout2MediaSyncGroup.h"
+#include "Spout2MediaSyncGroupState.h"
 #include "SpoutFrameSyncHelper.h"
-
-static spoutSenderNames senders;
+#include "SpoutReceiverBackend.h"
+#include "SpoutSenderDirectoryMapping.h"
+#include "SpoutSenderDiscovery.h"
+#include "SpoutSharedBuffers.h"
+#include "SpoutTransportRegistry.h"
 
 /////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Receive side of one opened sender. Created on Open, then used on the render thread only:
+ * each render thread frame it discovers the sender, opens its texture, records the copy and posts
+ * the sample in one pass. Registered and unregistered on the render thread, see Open and CloseContext.
+ */
 struct FSpout2MediaPlayer::FSpoutReceiverContext
+	: public FTickableObjectRenderThread
 {
+	std::string SenderName;
+	bool bSRGB = true;
+	FTimespan FrameDuration;
+
+	TSharedPtr<FSpout2MediaTextureSamplePool, ESPMode::ThreadSafe> SamplePool;
+	TSharedPtr<FSpout2MediaSampleMailbox, ESPMode::ThreadSafe> SampleMailbox;
+
+	// Sender texture description the backend was created for
 	unsigned int Width = 0, Height = 0;
 	DXGI_FORMAT DXFormat = DXGI_FORMAT_UNKNOWN;
 	EPixelFormat PixelFormat = PF_Unknown;
 
-	ID3D11DeviceContext* Context = nullptr;
-	
-	ID3D11Device* D3D11Device = nullptr;
-	ID3D12Device* D3D12Device = nullptr;
-	ID3D11On12Device* D3D11on12Device = nullptr;
+	// Imports the sender texture and copies it into samples
+	TUniquePtr<ISpoutReceiverBackend> Backend;
+
+	// Set once the native D3D12 backend could not open a share handle D3D11On12 could, see OpenSharedTexture
+	bool bD3D12OpenFailed = false;
+
+	// Sender frame counter kept by Spout, used to skip ticks without a new frame
+	spoutFrameCount FrameCount;
+
+	// Senders of this plugin are resolved in the sender directory, others by the discovery service
+	FSpoutSenderDirectoryLookup SenderLookup;
+
+	// Latest discovery event, written on the discovery thread
+	FCriticalSection DiscoveryLock;
+	bool bSenderDiscovered = false;
+	FSpoutSenderDescription DiscoveredSender;
+	uint32 DiscoverySubscription = 0;
+
+	// Set when the sender is multi-buffered, then each buffer has its own backend and
+	// the latest complete buffer is read instead of the texture in the sender info
+	FSpoutSharedBufferMapping BufferMapping;
+	TUniquePtr<SpoutBufferIndex::FReader> BufferReader;
+	TUniquePtr<ISpoutReceiverBackend> BufferBackends[SpoutBufferIndex::MaxBuffers];
+	uint64 LastBufferSequence = 0;
 
-	FSpoutReceiverContext(unsigned int Width, unsigned int Height, DXGI_FORMAT DXFormat)
-		: Width(Width)
-		, Height(Height)
-		, DXFormat(DXFormat)
+	// Share handle of the sender info when the mapping was last looked for
+	HANDLE LastShareHandle = nullptr;
+
+	// Buffers read by copies still in flight, given back to the sender once the copy completed
+	struct FHeldBuffer
+	{
+		uint32 Index;
+		FSpout2MediaTextureSamplePool::FSamplePtr Sample;
+	};
+	TArray<FHeldBuffer, TInlineAllocator<SpoutBufferIndex::MaxBuffers>> HeldBuffers;
+
+	// CPU frame transport, used instead of the Spout sender lookup when the source asks for one.
+	// The backend uploads the latest acquired frame, which is held until the upload was recorded.
+	std::unique_ptr<SpoutTransport::IReceiver> TransportReceiver;
+	FSpoutTransportReceiverBackend TransportBackend;
+	uint64 LastTransportFrame = 0;
+
+	// Transport is nullptr for Spout shared textures, TransportSenderName is then unused
+	FSpoutReceiverContext(const char* SenderName, bool bSRGB, FTimespan FrameDuration,
+		const TSharedPtr<FSpout2MediaTextureSamplePool, ESPMode::ThreadSafe>& SamplePool,
+		const TSharedPtr<FSpout2MediaSampleMailbox, ESPMode::ThreadSafe>& SampleMailbox,
+		SpoutTransport::ITransport* Transport = nullptr, const char* TransportSenderName = nullptr)
+		: FTickableObjectRenderThread(false)
+		, SenderName(SenderName)
+		, bSRGB(bSRGB)
+		, FrameDuration(FrameDuration)
+		, SamplePool(SamplePool)
+		, SampleMailbox(SampleMailbox)
+		, SenderLookup(SenderName)
 	{
-		if (DXFormat == DXGI_FORMAT_B8G8R8A8_UNORM)
-			PixelFormat = PF_B8G8R8A8;
-		else if (DXFormat == DXGI_FORMAT_R16G16B16A16_FLOAT)
-			PixelFormat = PF_FloatRGBA;
-		else if (DXFormat == DXGI_FORMAT_R32G32B32A32_FLOAT)
-			PixelFormat = PF_A32B32G32R32F;
+		if (Transport)
+		{
+			TransportReceiver = Transport->CreateReceiver(TransportSenderName);
+			return;
+		}
 
-		FString RHIName = GDynamicRHI->GetName();
+		FrameCount.EnableFrameCount(SenderName);
+	}
 
-		if (RHIName == TEXT("D3D11"))
+	~FSpoutReceiverContext()
+	{
+		if (!TransportReceiver)
 		{
-			D3D11Device = (ID3D11Device*)GDynamicRHI->RHIGetNativeDevice();
-			D3D11Device->GetImmediateContext(&Context);
+			FrameCount.CleanupFrameCount();
 		}
-		else if (RHIName == TEXT("D3D12"))
+
+		CloseBuffers();
+		Backend.Reset();
+	}
+
+	void OpenBuffers()
+	{
+		if (BufferMapping.Open(SenderName))
 		{
-			D3D12Device = static_cast<ID3D12Device*>(GDynamicRHI->RHIGetNativeDevice());
-			UINT DeviceFlags11 = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
+			BufferReader = MakeUnique<SpoutBufferIndex::FReader>(BufferMapping.GetLayout());
+		}
+	}
+
+	void CloseBuffers()
+	{
+		for (const FHeldBuffer& HeldBuffer : HeldBuffers)
+		{
+			BufferReader->EndRead(HeldBuffer.Index);
+		}
+		HeldBuffers.Reset();
 
-			verify(D3D11On12CreateDevice(
-				D3D12Device,
-				DeviceFlags11,
-				nullptr,
-				0,
-				nullptr,
-				0,
-				0,
-				&D3D11Device,
-				&Context,
-				nullptr
-			) == S_OK);
+		BufferReader.Reset();
+		BufferMapping.Close();
 
-			verify(D3D11Device->QueryInterface(__uuidof(ID3D11On12Device), reinterpret_cast<void**>(&D3D11on12Device)) == S_OK);
+		for (TUniquePtr<ISpoutReceiverBackend>& BufferBackend : BufferBackends)
+		{
+			BufferBackend.Reset();
 		}
-		else throw;
+
+		LastBufferSequence = 0;
+		LastShareHandle = nullptr;
 	}
 
-	~FSpoutReceiverContext()
+	void ReleaseCompletedReads()
+	{
+		for (int32 Index = HeldBuffers.Num() - 1; Index >= 0; Index--)
+		{
+			if (HeldBuffers[Index].Sample->IsCopyComplete())
+			{
+				BufferReader->EndRead(HeldBuffers[Index].Index);
+				HeldBuffers.RemoveAtSwap(Index);
+			}
+		}
+	}
+
+	// Backend to copy the latest complete buffer of a multi-buffered sender with, nullptr when there is
+	// no newer one. OutBufferIndex is read until EndRead.
+	ISpoutReceiverBackend* BeginBufferRead(uint32& OutBufferIndex)
+	{
+		uint64 Sequence = 0;
+		OutBufferIndex = BufferReader->BeginRead(LastBufferSequence, Sequence);
+		if (OutBufferIndex == SpoutBufferIndex::NoBuffer)
+			return nullptr;
+
+		TUniquePtr<ISpoutReceiverBackend>& BufferBackend = BufferBackends[OutBufferIndex];
+		if (!BufferBackend)
+		{
+			BufferBackend = CreateBackend();
+			check(BufferBackend);
+		}
+
+		const uint32 Handle = BufferMapping.GetLayout().Handles[OutBufferIndex];
+		if (!OpenSharedTexture(BufferBackend, reinterpret_cast<HANDLE>(static_cast<UPTRINT>(Handle))))
+		{
+			BufferReader->EndRead(OutBufferIndex);
+			return nullptr;
+		}
+
+		LastBufferSequence = Sequence;
+		return BufferBackend.Get();
+	}
+
+	// Backend Spout2Media.ReceiverBackend selects, D3D11On12 instead of D3D12 once that failed to open a sender
+	TUniquePtr<ISpoutReceiverBackend> CreateBackend() const
+	{
+		ESpoutReceiverBackend Type = SpoutReceiverBackend::SelectForCurrentRHI();
+		if (Type == ESpoutReceiverBackend::D3D12 && bD3D12OpenFailed)
+		{
+			Type = ESpoutReceiverBackend::D3D11On12;
+		}
+
+		return SpoutReceiverBackend::Create(Type, PixelFormat);
+	}
+
+	// Opens ShareHandle on InOutBackend. The native D3D12 backend is replaced by D3D11On12 the first time
+	// it refuses a handle D3D11On12 opens, which happens with the legacy handles most Spout senders share.
+	bool OpenSharedTexture(TUniquePtr<ISpoutReceiverBackend>& InOutBackend, HANDLE ShareHandle)
+	{
+		if (InOutBackend->OpenSharedTexture(ShareHandle))
+			return true;
+
+		if (InOutBackend->GetType() != ESpoutReceiverBackend::D3D12)
+			return false;
+
+		// A handle neither can open is stale, the sender is gone rather than incompatible
+		TUniquePtr<ISpoutReceiverBackend> Fallback = SpoutReceiverBackend::Create(ESpoutReceiverBackend::D3D11On12, PixelFormat);
+		if (!Fallback->OpenSharedTexture(ShareHandle))
+			return false;
+
+		if (!bD3D12OpenFailed)
+		{
+			UE_LOG(LogSpout2Media, Warning, TEXT("D3D12 could not open the shared texture of Spout sender %s, receiving it through D3D11On12 instead"),
+				ANSI_TO_TCHAR(SenderName.c_str()));
+			bD3D12OpenFailed = true;
+		}
+
+		InOutBackend = MoveTemp(Fallback);
+		return true;
+	}
+
+	// Description of the sender texture, false when the sender is gone
+	bool FindSender(unsigned int& OutWidth, unsigned int& OutHeight, HANDLE& OutShareHandle, DXGI_FORMAT& OutFormat)
+	{
+		if (!SenderLookup.Update() || SenderLookup.GetInfo().Transport != static_cast<uint32>(ESpout2MediaTransport::SharedTexture))
+		{
+			FScopeLock Lock(&DiscoveryLock);
+			if (!bSenderDiscovered)
+				return false;
+
+			OutWidth = DiscoveredSender.Width;
+			OutHeight = DiscoveredSender.Height;
+			OutShareHandle = reinterpret_cast<HANDLE>(static_cast<UPTRINT>(DiscoveredSender.ShareHandle));
+			OutFormat = static_cast<DXGI_FORMAT>(DiscoveredSender.Format);
+			return true;
+		}
+
+		const SpoutSenderDirectory::FSenderInfo& Info = SenderLookup.GetInfo();
+
+		// The directory ignores the FPS suffix, follow the name the sender actually goes by
+		if (SenderName != Info.Name)
+		{
+			FrameCount.CleanupFrameCount();
+			SenderName = Info.Name;
+			FrameCount.EnableFrameCount(SenderName.c_str());
+			CloseBuffers();
+		}
+
+		OutWidth = Info.Width;
+		OutHeight = Info.Height;
+		OutShareHandle = reinterpret_cast<HANDLE>(static_cast<UPTRINT>(Info.ShareHandle));
+		OutFormat = static_cast<DXGI_FORMAT>(Info.Format);
+		return true;
+	}
+
+	void OnSenderEvent(ESpoutSenderEvent Event, const FSpoutSenderDescription& Sender)
+	{
+		FScopeLock Lock(&DiscoveryLock);
+		bSenderDiscovered = Event != ESpoutSenderEvent::Removed;
+		DiscoveredSender = Sender;
+	}
+
+	// Whether the sender published a frame since the last call.
+	// Senders that do not count frames leave the counter at zero and are always treated as new.
+	bool IsNewFrame()
+	{
+		if (FrameCount.GetNewFrame())
+			return true;
+
+		return FrameCount.GetSenderFrame() <= 0;
+	}
+
+	//~ FTickableObjectRenderThread interface
+	virtual void Tick(float DeltaTime) override
+	{
+		Tick_RenderThread(FRHICommandListExecutor::GetImmediateCommandList());
+	}
+
+	virtual bool IsTickable() const override { return true; }
+
+	virtual TStatId GetStatId() const override
 	{
-		if (D3D11on12Device)
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FSpoutReceiverContext, STATGROUP_Spout2Media);
+	}
+
+	void Tick_RenderThread(FRHICommandListImmediate& RHICmdList)
+	{
+		check(IsInRenderingThread());
+
+		if (TransportReceiver)
 		{
-			D3D11on12Device->Release();
-			D3D11on12Device = nullptr;
+			TickTransport_RenderThread(RHICmdList);
+			return;
 		}
 
-		if (D3D11Device)
+		if (BufferReader)
 		{
-			D3D11Device->Release();
-			D3D11Device = nullptr;
+			ReleaseCompletedReads();
 		}
 
-		if (D3D12Device)
+		unsigned int SpoutWidth = 0, SpoutHeight = 0;
+		HANDLE SpoutShareHandle = nullptr;
+		DXGI_FORMAT SpoutFormat = DXGI_FORMAT_UNKNOWN;
+
+		if (!FindSender(SpoutWidth, SpoutHeight, SpoutShareHandle, SpoutFormat))
 		{
-			D3D12Device->Release();
-			D3D12Device = nullptr;
+			CloseBuffers();
+			return;
 		}
 
-		if (Context)
+		if (!Backend
+			|| Width != SpoutWidth
+			|| Height != SpoutHeight
+			|| DXFormat != SpoutFormat)
 		{
-			Context->Release();
-			Context = nullptr;
+			// Every format a Spout2 Media Output shares, zero-copy senders included, plus the usual Spout ones
+			EPixelFormat NewPixelFormat = PF_Unknown;
+
+			if (SpoutFormat == DXGI_FORMAT_B8G8R8A8_UNORM)
+				NewPixelFormat = PF_B8G8R8A8;
+			else if (SpoutFormat == DXGI_FORMAT_R8G8B8A8_UNORM)
+				NewPixelFormat = PF_R8G8B8A8;
+			else if (SpoutFormat == DXGI_FORMAT_R10G10B10A2_UNORM)
+				NewPixelFormat = PF_A2B10G10R10;
+			else if (SpoutFormat == DXGI_FORMAT_R16G16B16A16_FLOAT)
+				NewPixelFormat = PF_FloatRGBA;
+			else if (SpoutFormat == DXGI_FORMAT_R32G32B32A32_FLOAT)
+				NewPixelFormat = PF_A32B32G32R32F;
+
+			if (NewPixelFormat == PF_Unknown)
+				return;
+
+			Width = SpoutWidth;
+			Height = SpoutHeight;
+			DXFormat = SpoutFormat;
+			PixelFormat = NewPixelFormat;
+
+			Backend = CreateBackend();
+			check(Backend);
+
+			CloseBuffers();
 		}
 
+		// Multi-buffered senders publish a mapping, looked for again whenever the sender info changed
+		if (!BufferReader && SpoutShareHandle != LastShareHandle)
+		{
+			LastShareHandle = SpoutShareHandle;
+			OpenBuffers();
+		}
+
+		ISpoutReceiverBackend* CopyBackend = nullptr;
+		uint32 BufferIndex = SpoutBufferIndex::NoBuffer;
+
+		// Nothing to copy until the sender publishes again, FetchVideo keeps reporting no new sample
+		if (BufferReader)
+		{
+			CopyBackend = BeginBufferRead(BufferIndex);
+			if (!CopyBackend)
+			{
+				INC_DWORD_STAT(STAT_Spout2Media_SkippedCopies);
+				return;
+			}
+		}
+		else
+		{
+			if (!IsNewFrame())
+			{
+				INC_DWORD_STAT(STAT_Spout2Media_SkippedCopies);
+				return;
+			}
+
+			if (!OpenSharedTexture(Backend, SpoutShareHandle))
+				return;
+
+			CopyBackend = Backend.Get();
+		}
+
+		FSpout2MediaTextureSamplePool::FSamplePtr Sample = CopyToNewSample(RHICmdList, CopyBackend);
+
+		// The sender does not write the buffer again until the copy completed
+		if (BufferIndex != SpoutBufferIndex::NoBuffer)
+		{
+			if (Sample)
+			{
+				HeldBuffers.Add({ BufferIndex, Sample });
+			}
+			else
+			{
+				BufferReader->EndRead(BufferIndex);
+			}
+		}
+
+		if (!Sample)
+			return;
+
+		PostSample(Sample, BufferReader ? static_cast<int64>(LastBufferSequence) : FrameCount.GetSenderFrame());
+	}
+
+	// Transport counterpart of Tick_RenderThread, uploads the latest frame the transport has
+	void TickTransport_RenderThread(FRHICommandListImmediate& RHICmdList)
+	{
+		const SpoutTransport::FFramePtr Frame = TransportReceiver->AcquireLatest(LastTransportFrame);
+		if (!Frame)
+		{
+			INC_DWORD_STAT(STAT_Spout2Media_SkippedCopies);
+			return;
+		}
+
+		const SpoutTransport::FFrameInfo& Info = Frame->Info;
+		LastTransportFrame = Info.FrameNumber;
+
+		const EPixelFormat FramePixelFormat = static_cast<EPixelFormat>(Info.PixelFormat);
+		if (Info.PixelFormat >= PF_MAX
+			|| Info.Width == 0
+			|| Info.Height == 0
+			|| static_cast<uint64>(Info.Stride) * Info.Height > Info.Size
+			|| Info.Stride < Info.Width * GPixelFormats[FramePixelFormat].BlockBytes)
+			return;
+
+		Width = Info.Width;
+		Height = Info.Height;
+		DXFormat = DXGI_FORMAT_UNKNOWN;
+		PixelFormat = FramePixelFormat;
+
+		// Uploaded straight from the transport's frame, the loopback's is the one the sender wrote
+		TransportBackend.SetFrame(Frame->Data.data(), Info.Stride);
+		FSpout2MediaTextureSamplePool::FSamplePtr Sample = CopyToNewSample(RHICmdList, &TransportBackend);
+		TransportBackend.CloseSharedTexture();
+
+		if (!Sample)
+			return;
+
+		PostSample(Sample, static_cast<int64>(Info.FrameNumber));
+	}
+
+	// Acquires a sample and records CopyBackend's copy into it, nullptr when the copy was not recorded
+	FSpout2MediaTextureSamplePool::FSamplePtr CopyToNewSample(FRHICommandListImmediate& RHICmdList, ISpoutReceiverBackend* CopyBackend)
+	{
+		auto Sample = SamplePool->AcquireShared();
+		if (!Sample)
+		{
+			// Every pooled sample is still held downstream, the fetching side fell behind
+			INC_DWORD_STAT(STAT_Spout2Media_ReceiveFramesDropped);
+			return nullptr;
+		}
+
+		FSpout2MediaTextureSample::InitializeArguments Args;
+		Args.Width = Width;
+		Args.Height = Height;
+		Args.DXFormat = DXFormat;
+		Args.PixelFormat = PixelFormat;
+		Args.Backend = CopyBackend;
+
+		Args.bSRGB = bSRGB;
+
+		SCOPE_CYCLE_COUNTER(STAT_Spout2Media_ReceiveCopy);
+		if (!Sample->Initialize(RHICmdList, Args))
+			return nullptr;
+
+		return Sample;
+	}
+
+	void PostSample(const FSpout2MediaTextureSamplePool::FSamplePtr& Sample, int64 SenderFrame)
+	{
+		// Stamped on the clock GetTime reports, the frame lasts one sender frame
+		Sample->SetTime(FMediaTimeStamp(Spout2MediaClock::Now()), FrameDuration);
+
+		// Sync groups align the samples of different senders on it
+		Sample->SetSenderFrame(SenderFrame);
+
+		// Presented once the GPU finished the copy, see PromoteCompletedSamples
+		if (!SampleMailbox->Post(Sample))
+		{
+			INC_DWORD_STAT(STAT_Spout2Media_ReceiveFramesDropped);
+		}
 	}
 };
 
@@ -110,6 +494,10 @@ FSpout2MediaPlayer::FSpout2MediaPlayer(IMediaEventSink& InEventSink)
     bUseFrameSync = false;
     bLinkRenderingToFrameSync = false;
     FrameSyncHelper = MakeShared<FSpoutFrameSyncHelper>();
+    static_assert(MaxSyncGroupSamples == FSpout2MediaSyncGroupState::MaxPendingSamples, "The pool covers the samples a sync group holds back");
+    SamplePool = MakeShared<FSpout2MediaTextureSamplePool, ESPMode::ThreadSafe>(MaxPooledSamples);
+    SampleMailbox = MakeShared<FSpout2MediaSampleMailbox, ESPMode::ThreadSafe>(SampleMailboxCapacity);
+    SampleQueue = MakeShared<FSpout2MediaSampleQueue, ESPMode::ThreadSafe>();
 }
 
 FSpout2MediaPlayer::~FSpout2MediaPlayer()
@@ -127,7 +515,8 @@ FSpout2MediaPlayer::~FSpout2MediaPlayer()
 		Fence.Wait();
 	}
 	
-	Context.Reset();
+	CloseContext();
+	LeaveSyncGroup();
 }
 
 void FSpout2MediaPlayer::Close()
@@ -152,7 +541,49 @@ void FSpout2MediaPlayer::Close()
 	}
 	
 	CurrentState = EMediaState::Closed;
-	Context.Reset();
+	CloseContext();
+	LeaveSyncGroup();
+	SyncSourceName.Reset();
+	
+	// Drop the idle pooled samples, those still in use or being copied into stay pooled for the next Open
+	FlushSamples();
+	SamplePool->Reset();
+}
+
+void FSpout2MediaPlayer::CloseContext()
+{
+	if (!Context)
+		return;
+	
+	// The callback points at the context, done before it may go away
+	FSpoutSenderDiscovery* SenderDiscovery = FSpout2MediaModule::GetSenderDiscovery();
+	if (Context->DiscoverySubscription != 0 && SenderDiscovery)
+	{
+		SenderDiscovery->Unsubscribe(Context->DiscoverySubscription);
+	}
+	
+	// Unregistered where it ticks, the command's reference keeps the context alive until then
+	ENQUEUE_RENDER_COMMAND(SpoutReceiverUnregister)([ReceiverContext = MoveTemp(Context)](FRHICommandListImmediate& RHICmdList) {
+		ReceiverContext->Unregister();
+	});
+}
+
+void FSpout2MediaPlayer::TickReceiver_RenderThread(FRHICommandListImmediate& RHICmdList)
+{
+	if (Context)
+	{
+		Context->Tick_RenderThread(RHICmdList);
+	}
+}
+
+void FSpout2MediaPlayer::LeaveSyncGroup()
+{
+	if (!SyncGroup)
+		return;
+
+	SyncGroup->Leave(SyncGroupMemberId);
+	SyncGroup.Reset();
+	SyncGroupMemberId = INDEX_NONE;
 }
 
 IMediaCache& FSpout2MediaPlayer::GetCache()
@@ -264,6 +695,7 @@ bool FSpout2MediaPlayer::Open(const FString& Url, const IMediaOptions* Options)
 	if (Source)
 	{
 		bSRGB = Source->bSRGB;
+		FrameSyncTimeoutMs = FMath::Max(Source->FrameSyncTimeoutMs, 0);
 		
 		// Enable frame synchronization if requested in the source
 		SetUseFrameSync(Source->bUseFrameSync);
@@ -277,10 +709,55 @@ bool FSpout2MediaPlayer::Open(const FString& Url, const IMediaOptions* Options)
 			FrameRate = Source->TargetFrameRate;
 		}
 		
+		{
+			FScopeLock Lock(&SamplesLock);
+			SampleQueue->Configure(Source->BufferPolicy, Source->BufferDepth, Source->DelayFrames);
+		}
+		
 		// Note: Since OnPreRender doesn't exist in this version of UE, we'll use a different approach
 		// for frame synchronization (the WaitForSync method will handle this)
 	}
 	
+	if (CurrentState == EMediaState::Playing)
+	{
+		// Sender names are resolved once here, the receive path and the sync waits reuse them every frame
+		const FString FullName = SubscribeName.ToString();
+		if (!FullName.Split(TEXT("|FPS="), &SyncSourceName, nullptr))
+		{
+			SyncSourceName = FullName;
+		}
+		
+		LeaveSyncGroup();
+		if (Source && Source->SyncGroup)
+		{
+			SyncGroup = Source->SyncGroup->GetState();
+			SyncGroupMemberId = SyncGroup->Join(SyncSourceName);
+		}
+		
+		// Transport senders are found by their name without FPS information, like the sync event
+		SpoutTransport::ITransport* Transport = Source ? SpoutTransportRegistry::Get(Source->Transport) : nullptr;
+		
+		CloseContext();
+		Context = MakeShared<FSpoutReceiverContext, ESPMode::ThreadSafe>(
+			StringCast<ANSICHAR>(*FullName).Get(), bSRGB, FTimespan::FromSeconds(FrameRate.AsInterval()),
+			SamplePool, SampleMailbox, Transport, StringCast<ANSICHAR>(*SyncSourceName).Get());
+		
+		// Spout senders that are not in the sender directory are looked for by the module's discovery thread
+		FSpoutSenderDiscovery* SenderDiscovery = FSpout2MediaModule::GetSenderDiscovery();
+		if (!Transport && SenderDiscovery)
+		{
+			Context->DiscoverySubscription = SenderDiscovery->Subscribe(FullName,
+				[ReceiverContext = Context.Get()](ESpoutSenderEvent Event, const FSpoutSenderDescription& Sender)
+				{
+					ReceiverContext->OnSenderEvent(Event, Sender);
+				});
+		}
+		
+		ENQUEUE_RENDER_COMMAND(SpoutReceiverRegister)([ReceiverContext = Context](FRHICommandListImmediate& RHICmdList) {
+			ReceiverContext->Register();
+		});
+	}
+	
 	return true;
 }
 
@@ -292,67 +769,7 @@ bool FSpout2MediaPlayer::Open(const TSharedRef<FArchive, ESPMode::ThreadSafe>& A
 
 void FSpout2MediaPlayer::TickFetch(FTimespan DeltaTime, FTimespan Timecode)
 {
-	unsigned int SpoutWidth = 0, SpoutHeight = 0;
-	HANDLE SpoutShareHandle = nullptr;
-	DXGI_FORMAT SpoutFormat = DXGI_FORMAT_UNKNOWN;
-
-	const bool find_sender = senders.FindSender(
-		TCHAR_TO_ANSI(*SubscribeName.ToString()), SpoutWidth, SpoutHeight, SpoutShareHandle, reinterpret_cast<DWORD&>(SpoutFormat));
-
-	EPixelFormat PixelFormat = PF_Unknown;
-
-	if (SpoutFormat == DXGI_FORMAT_B8G8R8A8_UNORM)
-		PixelFormat = PF_B8G8R8A8;
-	else if (SpoutFormat == DXGI_FORMAT_R16G16B16A16_FLOAT)
-		PixelFormat = PF_FloatRGBA;
-	else if (SpoutFormat == DXGI_FORMAT_R32G32B32A32_FLOAT)
-		PixelFormat = PF_A32B32G32R32F;
-
-	if (!find_sender
-	|| PixelFormat == PF_Unknown)
-		return;
-
-	{
-		if (!Context
-			|| Context->Width != SpoutWidth
-			|| Context->Height != SpoutHeight
-			|| Context->DXFormat != SpoutFormat)
-		{
-			Context = MakeShared<FSpoutReceiverContext>(SpoutWidth, SpoutHeight, SpoutFormat);
-		}
-		
-		ENQUEUE_RENDER_COMMAND(SpoutRecieverRenderThreadOp)([this, SpoutShareHandle](FRHICommandListImmediate& RHICmdList) {
-			check(IsInRenderingThread());
-
-			auto Sample = MakeShared<FSpout2MediaTextureSample, ESPMode::ThreadSafe>();
-			FSpout2MediaTextureSample::InitializeArguments Args;
-			Args.Width = Context->Width;
-			Args.Height = Context->Height;
-			Args.DXFormat = Context->DXFormat;
-			Args.PixelFormat = Context->PixelFormat;
-			Args.SpoutSharehandle = SpoutShareHandle;
-			
-			Args.Context = Context->Context;
-			Args.D3D11Device = Context->D3D11Device;
-			Args.D3D12Device = Context->D3D12Device;
-			Args.D3D11on12Device = Context->D3D11on12Device;
-
-			Args.bSRGB = this->bSRGB;
-			
-			Sample->Initialize(Args);
-			
-			if (TextureSample)
-				TextureSample.Reset();
-			
-			TextureSample = Sample;
-		});
-	}
-	
-	// Update frame timestamp when new frame is received
-	if (TextureSample.IsValid())
-	{
-		FrameTimeStamp = FPlatformTime::Cycles64();
-	}
+	// Receiving is driven by the context's render thread tick, see FSpoutReceiverContext
 }
 
 void FSpout2MediaPlayer::TickInput(FTimespan DeltaTime, FTimespan Timecode)
@@ -375,46 +792,39 @@ void FSpout2MediaPlayer::WaitForSync()
 	if (CurrentState != EMediaState::Playing)
 		return;
 	
-	// If frame sync is enabled, use sync events
-	if (bUseFrameSync && FrameSyncHelper && !SubscribeName.IsNone())
+	// If frame sync is enabled, use sync events, those of the whole group when in one
+	if ((bUseFrameSync || SyncGroup) && FrameSyncHelper && !SubscribeName.IsNone())
 	{
-		// Extract source name without FPS info to match sender's actual name
-		FString SourceName = GetSourceName();
-		
-		// Wait for frame sync event with a reasonable timeout
-		if (FrameSyncHelper->WaitFrameSync(SourceName, 100))
-		{
-			// Update frame timestamp after successful sync
-			FrameTimeStamp = FPlatformTime::Cycles64();
+		if (WaitForFrameSync())
 			return;
-		}
 	}
 	
-	// Fall back to the original frame timestamp comparison method
-	int Count = 0;
-	while (Count < 1000)
+	// Otherwise wait until the render thread posted a received frame
+	SCOPE_CYCLE_COUNTER(STAT_Spout2Media_SyncWait);
+	
+	if (SampleMailbox->WaitForPost(FrameSyncTimeoutMs))
 	{
-		if (LastFrameTimeStamp != FrameTimeStamp)
-		{
-			LastFrameTimeStamp = FrameTimeStamp;
-			break;
-		}
-
-		FPlatformProcess::SleepNoStats(0.001);
-		Count += 1;
+		SET_FLOAT_STAT(STAT_Spout2Media_SyncWakeLatency,
+			FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - SampleMailbox->GetLastPostCycles()));
 	}
 }
 
+bool FSpout2MediaPlayer::WaitForFrameSync()
+{
+	return WaitForFrameSync(FrameSyncTimeoutMs);
+}
+
 bool FSpout2MediaPlayer::WaitForFrameSync(uint32 TimeoutMs)
 {
+	if (SyncGroup)
+		return SyncGroup->WaitForFrames(TimeoutMs);
+	
 	if (!bUseFrameSync || !FrameSyncHelper || SubscribeName.IsNone())
 		return false;
 	
-	// Extract source name without FPS info to match sender's actual name
-	FString SourceName = GetSourceName();
-	
-	// Wait for the sync event from the sender
-	return FrameSyncHelper->WaitFrameSync(SourceName, TimeoutMs);
+	// Wait for the sync event from the sender, named without the FPS info
+	SCOPE_CYCLE_COUNTER(STAT_Spout2Media_SyncWait);
+	return FrameSyncHelper->WaitFrameSync(SyncSourceName, TimeoutMs);
 }
 
 void FSpout2MediaPlayer::SetUseFrameSync(bool bEnable)
@@ -427,21 +837,14 @@ bool FSpout2MediaPlayer::IsFrameSyncEnabled() const
 	return bUseFrameSync;
 }
 
-FString FSpout2MediaPlayer::GetSourceName() const
+FTimespan FSpout2MediaPlayer::GetTime() const
 {
-	if (SubscribeName.IsNone())
-		return TEXT("");
-	
-	FString FullName = SubscribeName.ToString();
-	FString BaseName;
-	
-	// Strip off any FPS information if present
-	if (FullName.Split(TEXT("|FPS="), &BaseName, nullptr))
-	{
-		return BaseName;
-	}
-	
-	return FullName;
+	return Spout2MediaClock::Now();
+}
+
+const FString& FSpout2MediaPlayer::GetSourceName() const
+{
+	return SyncSourceName;
 }
 
 /////
@@ -454,29 +857,97 @@ bool FSpout2MediaPlayer::FetchVideo(TRange<FTimespan> TimeRange,
 		return false; // nothing to play
 	}
 
-	if (!TextureSample)
+	FScopeLock Lock(&SamplesLock);
+	PromoteCompletedSamples();
+	
+	TSharedPtr<FSpout2MediaTextureSample, ESPMode::ThreadSafe> Sample = SampleQueue->Dequeue();
+	if (!Sample)
 		return false;
 	
-	// Update frame timestamp when delivering a frame
-	FrameTimeStamp = FPlatformTime::Cycles64();
+	OutSample = Sample;
+	return true;
+}
+
+void FSpout2MediaPlayer::FlushSamples()
+{
+	IMediaSamples::FlushSamples();
 	
-	// Get frame information from Spout
-	if (Context)
+	FScopeLock Lock(&SamplesLock);
+	
+	TSharedPtr<FSpout2MediaTextureSample, ESPMode::ThreadSafe> Sample;
+	while (SampleMailbox->Take(Sample))
 	{
-		// Use default frame rate if we can't determine it from Spout
-		// (Spout doesn't provide direct frame rate info, so we use configured value)
 	}
 	
-	OutSample = TextureSample;
-	TextureSample.Reset();
-	
-	return true;
+	SampleQueue->Flush();
+	PendingSamples.Reset();
 }
 
-void FSpout2MediaPlayer::FlushSamples()
+void FSpout2MediaPlayer::PromoteCompletedSamples()
 {
-	IMediaSamples::FlushSamples();
-	TextureSample.Reset();
+	// Samples that never complete in time are dropped, the pool takes them back once their fence passed
+	TSharedPtr<FSpout2MediaTextureSample, ESPMode::ThreadSafe> Posted;
+	while (SampleMailbox->Take(Posted))
+	{
+		PendingSamples.Add(MoveTemp(Posted));
+	}
+
+	int32 Index = 0;
+	while (Index < PendingSamples.Num())
+	{
+		if (PendingSamples[Index]->IsCopyComplete())
+		{
+			if (SyncGroup)
+			{
+				SyncGroup->Submit(SyncGroupMemberId, PendingSamples[Index]);
+			}
+			else
+			{
+				SampleQueue->Enqueue(PendingSamples[Index]);
+			}
+			PendingSamples.RemoveAt(Index);
+		}
+		else
+		{
+			++Index;
+		}
+	}
+
+	if (PendingSamples.Num() > MaxPendingSamples)
+	{
+		PendingSamples.RemoveAt(0, PendingSamples.Num() - MaxPendingSamples);
+	}
+
+	if (SyncGroup)
+	{
+		TSharedPtr<FSpout2MediaTextureSample, ESPMode::ThreadSafe> Released;
+		while (SyncGroup->TakeReleased(SyncGroupMemberId, Released))
+		{
+			SampleQueue->Enqueue(Released);
+		}
+	}
+}
+
+IMediaSamples::EFetchBestSampleResult FSpout2MediaPlayer::FetchBestVideoSample(const TRange<FMediaTimeStamp>& TimeRange,
+	TSharedPtr<IMediaTextureSample, ESPMode::ThreadSafe>& OutSample)
+{
+	if ((CurrentState != EMediaState::Paused) && (CurrentState != EMediaState::Playing))
+	{
+		return EFetchBestSampleResult::NoneAvailable;
+	}
+
+	FScopeLock Lock(&SamplesLock);
+	PromoteCompletedSamples();
+
+	if (SampleQueue->Num() == 0)
+		return EFetchBestSampleResult::NoneAvailable;
+
+	TSharedPtr<FSpout2MediaTextureSample, ESPMode::ThreadSafe> Sample = SampleQueue->DequeueBest(TimeRange);
+	if (!Sample)
+		return EFetchBestSampleResult::NoneAvailable;
+
+	OutSample = Sample;
+	return EFetchBestSampleResult::Ok;
 }
 
 #if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 4
@@ -484,20 +955,23 @@ IMediaSamples::EFetchBestSampleResult FSpout2MediaPlayer::FetchBestVideoSampleFo
 	const TRange<FMediaTimeStamp>& TimeRange, TSharedPtr<IMediaTextureSample, ESPMode::ThreadSafe>& OutSample,
 	bool bReverse, bool bConsistentResult)
 {
-	return IMediaSamples::FetchBestVideoSampleForTimeRange(TimeRange, OutSample, bReverse, bConsistentResult);
+	return FetchBestVideoSample(TimeRange, OutSample);
 }
 #else
 IMediaSamples::EFetchBestSampleResult FSpout2MediaPlayer::FetchBestVideoSampleForTimeRange(
 	const TRange<FMediaTimeStamp>& TimeRange, TSharedPtr<IMediaTextureSample, ESPMode::ThreadSafe>& OutSample,
 	bool bReverse)
 {
-	return IMediaSamples::FetchBestVideoSampleForTimeRange(TimeRange, OutSample, bReverse);
+	return FetchBestVideoSample(TimeRange, OutSample);
 }
 #endif
 
 bool FSpout2MediaPlayer::PeekVideoSampleTime(FMediaTimeStamp& TimeStamp)
 {
-	return false;
+	FScopeLock Lock(&SamplesLock);
+	PromoteCompletedSamples();
+	
+	return SampleQueue->Peek(TimeStamp);
 }
 
 int32 FSpout2MediaPlayer::GetSelectedTrack(EMediaTrackType TrackType) const
@@ -543,10 +1017,7 @@ bool FSpout2MediaPlayer::GetVideoTrackFormat(int32 TrackIndex, int32 FormatIndex
 	OutFormat.FrameRate = 0;
 	OutFormat.FrameRates = TRange<float>(0, 0);
 
-	if (TextureSample)
-	{
-		OutFormat.Dim = TextureSample->GetDim();
-	}
+	OutFormat.Dim = SampleMailbox->GetLatestDim();
 	
 	return false;
 }
@@ -0,0 +1,156 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Spout2MediaSampleQueue.h"
+
+#include "Spout2MediaTextureSample.h"
+
+FSpout2MediaSampleQueue::FSpout2MediaSampleQueue()
+{
+	Configure(ESpout2MediaSampleBufferPolicy::NewestOnly, 1, 0);
+}
+
+void FSpout2MediaSampleQueue::Configure(ESpout2MediaSampleBufferPolicy InPolicy, int32 InDepth, int32 InDelayFrames)
+{
+	Policy = InPolicy;
+	DelayFrames = Policy == ESpout2MediaSampleBufferPolicy::FixedDelay ? FMath::Max(InDelayFrames, 0) : 0;
+
+	// The delayed frame has to fit next to the newest one
+	const int32 Capacity = FMath::Max3(InDepth, DelayFrames + 1, 1);
+
+	Samples.Reset();
+	Samples.SetNum(Capacity);
+	Head = 0;
+	Count = 0;
+}
+
+void FSpout2MediaSampleQueue::Enqueue(const FSamplePtr& Sample)
+{
+	if (Count == Samples.Num())
+	{
+		PopFront(1);
+	}
+
+	Samples[(Head + Count) % Samples.Num()] = Sample;
+	Count++;
+}
+
+FSpout2MediaSampleQueue::FSamplePtr FSpout2MediaSampleQueue::Dequeue()
+{
+	const int32 PresentIndex = GetPresentIndex();
+	if (PresentIndex == INDEX_NONE)
+		return nullptr;
+
+	FSamplePtr Sample = At(PresentIndex);
+	PopFront(PresentIndex + 1);
+	return Sample;
+}
+
+FSpout2MediaSampleQueue::FSamplePtr FSpout2MediaSampleQueue::DequeueBest(const TRange<FMediaTimeStamp>& TimeRange)
+{
+	const int32 PresentIndex = GetPresentIndex();
+	if (PresentIndex == INDEX_NONE)
+		return nullptr;
+
+	// A fixed delay presents the frame received DelayFrames frames ago, its time is compared that much later
+	const FTimespan Delay = At(PresentIndex)->GetDuration() * DelayFrames;
+
+	// Only the times matter, every sample is stamped on the one clock and has no sequence index
+	const TRangeBound<FMediaTimeStamp>& Lower = TimeRange.GetLowerBound();
+	const TRangeBound<FMediaTimeStamp>& Upper = TimeRange.GetUpperBound();
+
+	for (int32 Index = PresentIndex; Index >= 0; --Index)
+	{
+		const FSamplePtr& Sample = At(Index);
+		const FTimespan Start = Sample->GetTime().Time + Delay;
+		const FTimespan End = Start + Sample->GetDuration();
+
+		// Starts after the range, an older sample may be shown during it
+		if (Upper.IsClosed() && (Upper.IsInclusive() ? Start > Upper.GetValue().Time : Start >= Upper.GetValue().Time))
+			continue;
+
+		// Ended before the range started, and so did every older sample
+		if (Lower.IsClosed() && End <= Lower.GetValue().Time)
+		{
+			PopFront(Index + 1);
+			return nullptr;
+		}
+
+		FSamplePtr Best = Sample;
+		PopFront(Index + 1);
+		return Best;
+	}
+
+	return nullptr;
+}
+
+bool FSpout2MediaSampleQueue::Peek(FMediaTimeStamp& OutTime) const
+{
+	const int32 PresentIndex = GetPresentIndex();
+	if (PresentIndex == INDEX_NONE)
+		return false;
+
+	OutTime = At(PresentIndex)->GetTime();
+	return true;
+}
+
+void FSpout2MediaSampleQueue::Flush()
+{
+	PopFront(Count);
+}
+
+int32 FSpout2MediaSampleQueue::GetPresentIndex() const
+{
+	const int32 Index = Count - 1 - DelayFrames;
+	return Index >= 0 ? Index : INDEX_NONE;
+}
+
+void FSpout2MediaSampleQueue::PopFront(int32 NumToRemove)
+{
+	for (int32 Removed = 0; Removed < NumToRemove && Count > 0; ++Removed)
+	{
+		Samples[Head].Reset();
+		Head = (Head + 1) % Samples.Num();
+		Count--;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+FSpout2MediaSampleMailbox::FSpout2MediaSampleMailbox(uint32 Capacity)
+	: Capacity(Capacity)
+	, Samples(Capacity + 1)
+	, PostedEvent(FPlatformProcess::GetSynchEventFromPool(false))
+{
+}
+
+FSpout2MediaSampleMailbox::~FSpout2MediaSampleMailbox()
+{
+	FPlatformProcess::ReturnSynchEventToPool(PostedEvent);
+	PostedEvent = nullptr;
+}
+
+bool FSpout2MediaSampleMailbox::Post(const FSamplePtr& Sample)
+{
+	const FIntPoint Dim = Sample->GetDim();
+	LatestDim.store((uint64(uint32(Dim.X)) << 32) | uint32(Dim.Y), std::memory_order_relaxed);
+
+	// A take in progress may still count, the sample is dropped as if the consumer had not got to it
+	if (NumQueued.load(std::memory_order_acquire) >= Capacity || !Samples.Enqueue(Sample))
+		return false;
+
+	NumQueued.fetch_add(1, std::memory_order_release);
+	LastPostCycles.store(FPlatformTime::Cycles64(), std::memory_order_relaxed);
+	PostedEvent->Trigger();
+	return true;
+}
+
+bool FSpout2MediaSampleMailbox::WaitForPost(uint32 TimeoutMs)
+{
+	return PostedEvent->Wait(TimeoutMs);
+}
+
+FIntPoint FSpout2MediaSampleMailbox::GetLatestDim() const
+{
+	const uint64 Packed = LatestDim.load(std::memory_order_relaxed);
+	return FIntPoint(int32(Packed >> 32), int32(Packed & 0xffffffff));
+}
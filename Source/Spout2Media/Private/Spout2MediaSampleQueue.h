@@ -0,0 +1,130 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/CircularQueue.h"
+#include "HAL/Event.h"
+#include "IMediaTimeSource.h"
+
+#include <atomic>
+
+#include "Spout2MediaSource.h"
+
+class FSpout2MediaTextureSample;
+
+namespace Spout2MediaClock
+{
+	// Clock received samples are stamped on and the player reports from GetTime, so the time ranges the
+	// media framework fetches with compare directly to sample times. The same realtime clock the framework
+	// uses for players with UseRealtimeWithVideoOnly.
+	inline FTimespan Now()
+	{
+		return FTimespan::FromSeconds(FPlatformTime::Seconds());
+	}
+}
+
+/**
+ * Bounded ring of received samples whose copy completed, oldest first.
+ * The buffer policy decides which of them is presented: the newest one, or the one a fixed
+ * number of frames behind it. Only the thread fetching samples uses it.
+ */
+class FSpout2MediaSampleQueue
+{
+public:
+	using FSamplePtr = TSharedPtr<FSpout2MediaTextureSample, ESPMode::ThreadSafe>;
+
+	FSpout2MediaSampleQueue();
+
+	// Drops all samples and applies the buffer settings of a media source
+	void Configure(ESpout2MediaSampleBufferPolicy InPolicy, int32 InDepth, int32 InDelayFrames);
+
+	// Adds the newest received sample, the oldest one is dropped when the queue is full
+	void Enqueue(const FSamplePtr& Sample);
+
+	// Sample the policy presents now. It and all older samples leave the queue.
+	FSamplePtr Dequeue();
+
+	// Newest presentable sample shown during TimeRange, which is on the Spout2MediaClock. It and all older
+	// samples leave the queue. When the newest sample not after the range already ended before it started,
+	// it and all older samples are discarded and nothing is returned.
+	FSamplePtr DequeueBest(const TRange<FMediaTimeStamp>& TimeRange);
+
+	// Time of the sample Dequeue would return
+	bool Peek(FMediaTimeStamp& OutTime) const;
+
+	int32 Num() const { return Count; }
+	void Flush();
+
+private:
+	const FSamplePtr& At(int32 Index) const { return Samples[(Head + Index) % Samples.Num()]; }
+
+	// Index of the sample the policy presents now, INDEX_NONE while not enough frames arrived
+	int32 GetPresentIndex() const;
+
+	// Removes the oldest NumToRemove samples
+	void PopFront(int32 NumToRemove);
+
+	TArray<FSamplePtr> Samples;
+	int32 Head = 0;
+	int32 Count = 0;
+
+	ESpout2MediaSampleBufferPolicy Policy = ESpout2MediaSampleBufferPolicy::NewestOnly;
+	int32 DelayFrames = 0;
+};
+
+/**
+ * Lock-free handoff of samples from the render thread, which records their copy, to the thread
+ * fetching samples. Exactly one producer and one consumer; the producer never waits and drops
+ * the sample when the consumer fell behind.
+ *
+ * Neither side takes a lock, so there is no lock contention left to measure on the receive path.
+ * The Receive Frames Dropped stat replaces that measurement: it counts the posts that found the
+ * consumer too far behind, which is where contention between the two threads now shows.
+ */
+class FSpout2MediaSampleMailbox
+{
+public:
+	using FSamplePtr = FSpout2MediaSampleQueue::FSamplePtr;
+
+	explicit FSpout2MediaSampleMailbox(uint32 Capacity = 8);
+	~FSpout2MediaSampleMailbox();
+
+	// Producer side, returns false when Capacity samples wait to be taken. Wakes a consumer blocked in WaitForPost.
+	bool Post(const FSamplePtr& Sample);
+
+	// Consumer side
+	bool Take(FSamplePtr& OutSample)
+	{
+		if (!Samples.Dequeue(OutSample))
+			return false;
+
+		NumQueued.fetch_sub(1, std::memory_order_release);
+		return true;
+	}
+
+	uint32 GetCapacity() const { return Capacity; }
+
+	// Blocks until a sample was posted since the previous wait returned, or TimeoutMs elapsed
+	bool WaitForPost(uint32 TimeoutMs);
+
+	// FPlatformTime cycles of the last post, for measuring how late the consumer woke up
+	uint64 GetLastPostCycles() const { return LastPostCycles.load(std::memory_order_relaxed); }
+
+	// Dimension of the newest posted sample, readable from any thread
+	FIntPoint GetLatestDim() const;
+
+private:
+	// TCircularQueue rounds its size up to a power of two, the count keeps the mailbox to Capacity so the
+	// consumer and the sample pool can be sized from it
+	const uint32 Capacity;
+	std::atomic<uint32> NumQueued{0};
+	TCircularQueue<FSamplePtr> Samples;
+
+	// Auto-reset, so a post made while nobody waited satisfies the next wait
+	FEvent* PostedEvent = nullptr;
+	std::atomic<uint64> LastPostCycles{0};
+
+	// Width in the high and height in the low 32 bits, so both are read together
+	std::atomic<uint64> LatestDim{0};
+};
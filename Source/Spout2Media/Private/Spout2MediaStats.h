@@ -0,0 +1,37 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("Spout2Media"), STATGROUP_Spout2Media, STATCAT_Advanced);
+
+// Receive path
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sample Pool Hits"), STAT_Spout2Media_SamplePoolHits, STATGROUP_Spout2Media, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sample Pool Misses"), STAT_Spout2Media_SamplePoolMisses, STATGROUP_Spout2Media, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Samples Allocated"), STAT_Spout2Media_SamplesAllocated, STATGROUP_Spout2Media, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Sample Texture Memory"), STAT_Spout2Media_SampleTextureMemory, STATGROUP_Spout2Media, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Skipped Copies"), STAT_Spout2Media_SkippedCopies, STATGROUP_Spout2Media, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Receive Frames Dropped"), STAT_Spout2Media_ReceiveFramesDropped, STATGROUP_Spout2Media, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Receive Copy Submit"), STAT_Spout2Media_ReceiveCopy, STATGROUP_Spout2Media, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sync Wait"), STAT_Spout2Media_SyncWait, STATGROUP_Spout2Media, );
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Sync Wake Latency (ms)"), STAT_Spout2Media_SyncWakeLatency, STATGROUP_Spout2Media, );
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Clock Drift (ppm)"), STAT_Spout2Media_ClockDrift, STATGROUP_Spout2Media, );
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Clock Phase Error (ms)"), STAT_Spout2Media_ClockPhaseError, STATGROUP_Spout2Media, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Genlock Frames Dropped"), STAT_Spout2Media_GenlockFramesDropped, STATGROUP_Spout2Media, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Genlock Frames Repeated"), STAT_Spout2Media_GenlockFramesRepeated, STATGROUP_Spout2Media, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sync Group Wait"), STAT_Spout2Media_SyncGroupWait, STATGROUP_Spout2Media, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sync Group Sets Released"), STAT_Spout2Media_SyncGroupSetsReleased, STATGROUP_Spout2Media, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sync Group Frames Discarded"), STAT_Spout2Media_SyncGroupFramesDiscarded, STATGROUP_Spout2Media, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Discovery Scans"), STAT_Spout2Media_DiscoveryScans, STATGROUP_Spout2Media, );
+
+// Send path
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Capture Frame"), STAT_Spout2Media_CaptureFrame, STATGROUP_Spout2Media, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Send Copy Submit"), STAT_Spout2Media_SendCopy, STATGROUP_Spout2Media, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Send Frames Dropped"), STAT_Spout2Media_SendFramesDropped, STATGROUP_Spout2Media, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Send Deadlines Missed"), STAT_Spout2Media_SendDeadlinesMissed, STATGROUP_Spout2Media, );
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Send Pacing Jitter (ms)"), STAT_Spout2Media_SendJitter, STATGROUP_Spout2Media, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Wrapped Resources"), STAT_Spout2Media_WrappedResources, STATGROUP_Spout2Media, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Wrapped Resource Hits"), STAT_Spout2Media_WrappedResourceHits, STATGROUP_Spout2Media, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Wrapped Resource Misses"), STAT_Spout2Media_WrappedResourceMisses, STATGROUP_Spout2Media, );
@@ -0,0 +1,26 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Spout2MediaSyncGroup.h"
+#include "Spout2MediaSyncGroupState.h"
+
+USpout2MediaSyncGroup::USpout2MediaSyncGroup(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+}
+
+TSharedRef<FSpout2MediaSyncGroupState, ESPMode::ThreadSafe> USpout2MediaSyncGroup::GetState()
+{
+	if (!State)
+	{
+		State = MakeShared<FSpout2MediaSyncGroupState, ESPMode::ThreadSafe>();
+	}
+
+	FSpout2MediaSyncGroupState::FSettings Settings;
+	Settings.Alignment = Alignment;
+	Settings.ArrivalTolerance = FMath::Max(ArrivalToleranceMs, 0.0f) / 1000.0;
+	Settings.Timeout = FMath::Max(TimeoutMs, 1) / 1000.0;
+	State->Configure(Settings);
+
+	return State.ToSharedRef();
+}
@@ -0,0 +1,236 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Spout2MediaSyncGroupState.h"
+
+#include "Spout2MediaStats.h"
+#include "Spout2MediaTextureSample.h"
+
+void FSpout2MediaSyncGroupState::Configure(const FSettings& InSettings)
+{
+	FScopeLock ScopeLock(&Lock);
+	Settings = InSettings;
+}
+
+int32 FSpout2MediaSyncGroupState::Join(const FString& SyncSourceName)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	FMember& Member = Members.AddDefaulted_GetRef();
+	Member.Id = NextMemberId++;
+	Member.SyncEvent = FrameSyncHelper.GetFrameSyncEvent(SyncSourceName);
+
+	// Live from the start, so the group waits for the new member's first frame
+	Member.LastSubmitTime = Member.LastSignalTime = FPlatformTime::Seconds();
+	return Member.Id;
+}
+
+void FSpout2MediaSyncGroupState::Leave(int32 MemberId)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	Members.RemoveAll([MemberId](const FMember& Member) { return Member.Id == MemberId; });
+
+	// The others may have been waiting for this member
+	TryRelease();
+}
+
+FSpout2MediaSyncGroupState::FMember* FSpout2MediaSyncGroupState::FindMember(int32 MemberId)
+{
+	return Members.FindByPredicate([MemberId](const FMember& Member) { return Member.Id == MemberId; });
+}
+
+void FSpout2MediaSyncGroupState::Submit(int32 MemberId, const FSamplePtr& Sample)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	FMember* Member = FindMember(MemberId);
+	if (!Member)
+		return;
+
+	if (Member->Pending.Num() == MaxPendingSamples)
+	{
+		Member->Pending.RemoveAt(0);
+		INC_DWORD_STAT(STAT_Spout2Media_SyncGroupFramesDiscarded);
+	}
+
+	Member->Pending.Add(Sample);
+	Member->LastSubmitTime = FPlatformTime::Seconds();
+
+	TryRelease();
+}
+
+bool FSpout2MediaSyncGroupState::TakeReleased(int32 MemberId, FSamplePtr& OutSample)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	// Members that stopped receiving are noticed here, when nobody submits
+	TryRelease();
+
+	FMember* Member = FindMember(MemberId);
+	if (!Member || Member->Released.Num() == 0)
+		return false;
+
+	OutSample = Member->Released[0];
+	Member->Released.RemoveAt(0);
+	return true;
+}
+
+int32 FSpout2MediaSyncGroupState::FindMatch(const FMember& Member, const FSamplePtr& Key) const
+{
+	int32 BestIndex = INDEX_NONE;
+	double BestDistance = Settings.ArrivalTolerance;
+
+	for (int32 Index = Member.Pending.Num() - 1; Index >= 0; Index--)
+	{
+		const FSamplePtr& Sample = Member.Pending[Index];
+
+		if (Settings.Alignment == ESpout2MediaSyncGroupAlignment::FrameNumber)
+		{
+			if (Sample->GetSenderFrame() == Key->GetSenderFrame())
+				return Index;
+		}
+		else
+		{
+			const double Distance = FMath::Abs((Sample->GetTime().Time - Key->GetTime().Time).GetTotalSeconds());
+			if (Distance <= BestDistance)
+			{
+				BestIndex = Index;
+				BestDistance = Distance;
+			}
+		}
+	}
+
+	return BestIndex;
+}
+
+void FSpout2MediaSyncGroupState::TryRelease()
+{
+	const double Now = FPlatformTime::Seconds();
+
+	// Members that are not live do not take part, their samples are presented as they come
+	FMember* Reference = nullptr;
+	for (FMember& Member : Members)
+	{
+		if (!IsLive(Member, Now))
+		{
+			Member.Released.Append(Member.Pending);
+			Member.Pending.Reset();
+		}
+		else if (!Reference)
+		{
+			Reference = &Member;
+		}
+	}
+
+	if (!Reference)
+		return;
+
+	// Newest sample of the reference member that every other live member has a match for
+	TArray<int32, TInlineAllocator<MAXIMUM_WAIT_OBJECTS>> Matches;
+	for (int32 KeyIndex = Reference->Pending.Num() - 1; KeyIndex >= 0; KeyIndex--)
+	{
+		const FSamplePtr& Key = Reference->Pending[KeyIndex];
+		Matches.Reset();
+
+		bool bComplete = true;
+		for (FMember& Member : Members)
+		{
+			const int32 MatchIndex = IsLive(Member, Now) ? FindMatch(Member, Key) : INDEX_NONE;
+			if (IsLive(Member, Now) && MatchIndex == INDEX_NONE)
+			{
+				bComplete = false;
+				break;
+			}
+
+			Matches.Add(MatchIndex);
+		}
+
+		if (!bComplete)
+			continue;
+
+		// Release the set, the samples before it can no longer be part of one
+		for (int32 MemberIndex = 0; MemberIndex < Members.Num(); MemberIndex++)
+		{
+			const int32 MatchIndex = Matches[MemberIndex];
+			if (MatchIndex == INDEX_NONE)
+				continue;
+
+			FMember& Member = Members[MemberIndex];
+			Member.Released.Add(Member.Pending[MatchIndex]);
+
+			INC_DWORD_STAT_BY(STAT_Spout2Media_SyncGroupFramesDiscarded, MatchIndex);
+			Member.Pending.RemoveAt(0, MatchIndex + 1);
+		}
+
+		INC_DWORD_STAT(STAT_Spout2Media_SyncGroupSetsReleased);
+		return;
+	}
+}
+
+bool FSpout2MediaSyncGroupState::WaitForFrames(uint32 TimeoutMs)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Spout2Media_SyncGroupWait);
+
+	TArray<HANDLE, TInlineAllocator<MAXIMUM_WAIT_OBJECTS>> Events;
+	TArray<int32, TInlineAllocator<MAXIMUM_WAIT_OBJECTS>> MemberIds;
+	double SignalTimeout = 0.0;
+
+	{
+		FScopeLock ScopeLock(&Lock);
+
+		// Waiting again would consume the next frame's sync events
+		if (LastWaitFrame == GFrameCounter)
+			return bLastWaitResult;
+
+		SignalTimeout = Settings.Timeout;
+
+		const double Now = FPlatformTime::Seconds();
+		for (FMember& Member : Members)
+		{
+			if (!Member.SyncEvent || Events.Num() == MAXIMUM_WAIT_OBJECTS)
+				continue;
+
+			// Senders that went quiet are polled, so they do not stall the group for the timeout every frame
+			if (Now - Member.LastSignalTime >= SignalTimeout)
+			{
+				if (WaitForSingleObject(Member.SyncEvent, 0) == WAIT_OBJECT_0)
+				{
+					Member.LastSignalTime = Now;
+				}
+				continue;
+			}
+
+			Events.Add(Member.SyncEvent);
+			MemberIds.Add(Member.Id);
+		}
+	}
+
+	// Wakes on whichever event is signalled first and waits for the rest, until all of them signalled
+	const double Deadline = FPlatformTime::Seconds() + TimeoutMs / 1000.0;
+	while (Events.Num() > 0)
+	{
+		const double Remaining = Deadline - FPlatformTime::Seconds();
+		if (Remaining <= 0.0)
+			break;
+
+		const DWORD Result = WaitForMultipleObjects(Events.Num(), Events.GetData(), false, static_cast<DWORD>(FMath::CeilToDouble(Remaining * 1000.0)));
+		if (Result >= WAIT_OBJECT_0 + Events.Num())
+			break;
+
+		const int32 Index = Result - WAIT_OBJECT_0;
+		const int32 MemberId = MemberIds[Index];
+		Events.RemoveAtSwap(Index);
+		MemberIds.RemoveAtSwap(Index);
+
+		FScopeLock ScopeLock(&Lock);
+		if (FMember* Member = FindMember(MemberId))
+		{
+			Member->LastSignalTime = FPlatformTime::Seconds();
+		}
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	LastWaitFrame = GFrameCounter;
+	bLastWaitResult = Events.Num() == 0;
+	return bLastWaitResult;
+}
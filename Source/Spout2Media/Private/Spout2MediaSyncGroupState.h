@@ -0,0 +1,91 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <Windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+
+#include "Spout2MediaSampleQueue.h"
+#include "Spout2MediaSyncGroup.h"
+#include "SpoutFrameSyncHelper.h"
+
+/**
+ * Runtime side of a USpout2MediaSyncGroup, shared by the players of its member sources.
+ *
+ * Each member player submits the samples whose copy completed instead of presenting them, and presents
+ * the samples the group released for it. A set is released when every live member has a sample with the
+ * same key, the sender frame number or the arrival time; older samples are dropped. A member that
+ * received nothing for the timeout is not live and no longer holds the group back, its samples are
+ * released as they come.
+ */
+class FSpout2MediaSyncGroupState
+{
+public:
+	using FSamplePtr = FSpout2MediaSampleQueue::FSamplePtr;
+
+	// Samples kept per member while waiting for the others
+	static constexpr int32 MaxPendingSamples = 8;
+
+	struct FSettings
+	{
+		ESpout2MediaSyncGroupAlignment Alignment = ESpout2MediaSyncGroupAlignment::FrameNumber;
+		double ArrivalTolerance = 0.008;
+		double Timeout = 0.1;
+	};
+
+	void Configure(const FSettings& InSettings);
+
+	// Called where players open and close, SyncSourceName names the sender's sync event
+	int32 Join(const FString& SyncSourceName);
+	void Leave(int32 MemberId);
+
+	// Called by the member's thread fetching samples
+	void Submit(int32 MemberId, const FSamplePtr& Sample);
+	bool TakeReleased(int32 MemberId, FSamplePtr& OutSample);
+
+	// Waits with one multi-object wait until the sender of every live member signalled a frame.
+	// Members whose sender did not signal for the timeout are only polled. Every member calls it
+	// from WaitForSync, the first call of an engine frame waits and the others reuse its result.
+	bool WaitForFrames(uint32 TimeoutMs);
+
+private:
+	struct FMember
+	{
+		int32 Id = 0;
+		HANDLE SyncEvent = nullptr;
+
+		// Oldest first
+		TArray<FSamplePtr, TInlineAllocator<MaxPendingSamples>> Pending;
+		TArray<FSamplePtr, TInlineAllocator<MaxPendingSamples>> Released;
+
+		// FPlatformTime::Seconds of the last submitted sample and the last sync event
+		double LastSubmitTime = 0.0;
+		double LastSignalTime = 0.0;
+	};
+
+	FMember* FindMember(int32 MemberId);
+
+	bool IsLive(const FMember& Member, double Now) const { return Now - Member.LastSubmitTime < Settings.Timeout; }
+
+	// Index in Pending of the sample matching Key, INDEX_NONE without one
+	int32 FindMatch(const FMember& Member, const FSamplePtr& Key) const;
+
+	// Releases the newest complete set, under Lock
+	void TryRelease();
+
+	FSettings Settings;
+	TArray<FMember> Members;
+	int32 NextMemberId = 0;
+
+	// Owns the sync events, they stay open while a wait may use them
+	FSpoutFrameSyncHelper FrameSyncHelper;
+
+	// Engine frame of the last WaitForFrames and its result
+	uint64 LastWaitFrame = MAX_uint64;
+	bool bLastWaitResult = false;
+
+	FCriticalSection Lock;
+};
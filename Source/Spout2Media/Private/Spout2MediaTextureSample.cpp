@@ -2,6 +2,8 @@
 
 
 #include "Spout2MediaTextureSample.h"
+#include "Spout2MediaStats.h"
+#include "SpoutReceiverBackend.h"
 
 FSpout2MediaTextureSample::FSpout2MediaTextureSample()
 	: Args({})
@@ -13,89 +15,108 @@ FSpout2MediaTextureSample::~FSpout2MediaTextureSample()
 	Destroy();
 }
 
-void FSpout2MediaTextureSample::Initialize(const InitializeArguments& Args_)
+bool FSpout2MediaTextureSample::Initialize(FRHICommandListImmediate& RHICmdList, const InitializeArguments& Args_)
 {
-	Args = Args_;
+	if (CanReuseTexture(Args_))
+	{
+		INC_DWORD_STAT(STAT_Spout2Media_SamplePoolHits);
+		Args = Args_;
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_Spout2Media_SamplePoolMisses);
+
+		Destroy();
+		Args = Args_;
+		CreateTexture();
+	}
+	
+	// Recorded in the same render thread pass that acquired the sample, so it is posted with its copy
+	return Args.Backend->CopyToSample(RHICmdList, *this);
+}
 
+void FSpout2MediaTextureSample::SetTime(const FMediaTimeStamp& InTime, FTimespan InDuration)
+{
+	Time = InTime;
+	Duration = InDuration;
+}
+
+void FSpout2MediaTextureSample::CreateTexture()
+{
 	ETextureCreateFlags Flags = ETextureCreateFlags::RenderTargetable;
 
 	if (Args.bSRGB)
 		Flags |= ETextureCreateFlags::SRGB;
 	
-	FRHIResourceCreateInfo CreateInfo(L"Spout2MediaTextureSample");
 	FRHITextureCreateDesc TextureDesc = FRHITextureCreateDesc::Create2D(
 		L"Spout2MediaTextureSample",
 		FIntPoint(Args.Width, Args.Height), Args.PixelFormat
 		);
 	TextureDesc.SetFlags(Flags);
 	Texture = RHICreateTexture(TextureDesc);
-	
-	RHIName = GDynamicRHI->GetName();
-	
-	if (RHIName == TEXT("D3D12"))
-	{
-		D3D11_RESOURCE_FLAGS rf11 = {};
-		ID3D12Resource* NativeTex = (ID3D12Resource*)Texture->GetNativeResource();
-	
-		verify(Args.D3D11on12Device->CreateWrappedResource(
-			NativeTex, &rf11,
-			D3D12_RESOURCE_STATE_COPY_DEST,
-			D3D12_RESOURCE_STATE_PRESENT, __uuidof(ID3D11Resource),
-			(void**)&WrappedDX11Resource) == S_OK);
 
-		NativeTex->Release();
-	}
-	
-	ENQUEUE_RENDER_COMMAND(SpoutRecieverRenderThreadOp)([this](FRHICommandListImmediate& RHICmdList) {
-		check(IsInRenderingThread());
-		
-		ID3D11Resource* SrcTexture = nullptr;
-		
-		verify(Args.D3D11Device->OpenSharedResource(Args.SpoutSharehandle, __uuidof(ID3D11Resource), (void**)(&SrcTexture)) == S_OK);
-		check(SrcTexture);
-	
-		CopyResource(SrcTexture);
-		
-		SrcTexture->Release();
-	});
+	TextureBytes = static_cast<SIZE_T>(Args.Width) * Args.Height * GPixelFormats[Args.PixelFormat].BlockBytes;
+	INC_MEMORY_STAT_BY(STAT_Spout2Media_SampleTextureMemory, TextureBytes);
 }
 
-void FSpout2MediaTextureSample::Destroy()
+void FSpout2MediaTextureSample::ReleaseWrappedResource()
 {
 	if (WrappedDX11Resource)
 	{
-		Args.D3D11on12Device->ReleaseWrappedResources(&WrappedDX11Resource, 1);
+		WrappedDX11Resource->Release();
 		WrappedDX11Resource = nullptr;
 	}
 
+	WrappedDevice = nullptr;
+}
+
+void FSpout2MediaTextureSample::Destroy()
+{
+	ReleaseWrappedResource();
+
 	if (Texture)
 	{
+		DEC_MEMORY_STAT_BY(STAT_Spout2Media_SampleTextureMemory, TextureBytes);
+		TextureBytes = 0;
+
 		Texture.SafeRelease();
 		Texture = nullptr;
 	}
 }
 
-void FSpout2MediaTextureSample::CopyResource(ID3D11Resource* SrcTexture)
+bool FSpout2MediaTextureSample::CanReuseTexture(const InitializeArguments& NewArgs) const
 {
-	check(IsInRenderingThread());
-	if (!GWorld || !SrcTexture) return;
+	return Texture.IsValid()
+		&& Args.Width == NewArgs.Width
+		&& Args.Height == NewArgs.Height
+		&& Args.PixelFormat == NewArgs.PixelFormat
+		&& Args.bSRGB == NewArgs.bSRGB;
+}
 
-	if (RHIName == TEXT("D3D11"))
-	{
-		ID3D11Texture2D* NativeTex = (ID3D11Texture2D*)Texture->GetNativeResource();
+ID3D11Resource* FSpout2MediaTextureSample::GetWrappedResource(ID3D11On12Device* D3D11on12Device)
+{
+	if (WrappedDX11Resource && WrappedDevice == D3D11on12Device)
+		return WrappedDX11Resource;
 
-		Args.Context->CopyResource(NativeTex, SrcTexture);
-		Args.Context->Flush();
-	}
-	else if (RHIName == TEXT("D3D12"))
-	{
-		Args.D3D11on12Device->AcquireWrappedResources(&WrappedDX11Resource, 1);
-		Args.Context->CopyResource(WrappedDX11Resource, SrcTexture);
-		Args.D3D11on12Device->ReleaseWrappedResources(&WrappedDX11Resource, 1);
-		Args.Context->Flush();
-	}
+	ReleaseWrappedResource();
+
+	if (!Texture || !D3D11on12Device)
+		return nullptr;
+
+	D3D11_RESOURCE_FLAGS rf11 = {};
+	ID3D12Resource* NativeTex = (ID3D12Resource*)Texture->GetNativeResource();
+
+	verify(D3D11on12Device->CreateWrappedResource(
+		NativeTex, &rf11,
+		D3D12_RESOURCE_STATE_COPY_DEST,
+		D3D12_RESOURCE_STATE_PRESENT, __uuidof(ID3D11Resource),
+		(void**)&WrappedDX11Resource) == S_OK);
+
+	WrappedDevice = D3D11on12Device;
+	return WrappedDX11Resource;
 }
 
+
 const void* FSpout2MediaTextureSample::GetBuffer()
 {
 	return nullptr;
@@ -108,7 +129,7 @@ FIntPoint FSpout2MediaTextureSample::GetDim() const
 
 FTimespan FSpout2MediaTextureSample::GetDuration() const
 {
-	return FTimespan();
+	return Duration;
 }
 
 EMediaTextureSampleFormat FSpout2MediaTextureSample::GetFormat() const
@@ -117,6 +138,10 @@ EMediaTextureSampleFormat FSpout2MediaTextureSample::GetFormat() const
 	{
 	case PF_B8G8R8A8:
 		return EMediaTextureSampleFormat::CharBGRA;
+	case PF_R8G8B8A8:
+		return EMediaTextureSampleFormat::CharRGBA;
+	case PF_A2B10G10R10:
+		return EMediaTextureSampleFormat::CharBGR10A2;
 	case PF_FloatRGB:
 		return EMediaTextureSampleFormat::FloatRGB;
 	case PF_FloatRGBA:
@@ -148,7 +173,7 @@ FRHITexture* FSpout2MediaTextureSample::GetTexture() const
 
 FMediaTimeStamp FSpout2MediaTextureSample::GetTime() const
 {
-	return FMediaTimeStamp();
+	return Time;
 }
 
 bool FSpout2MediaTextureSample::IsCacheable() const
@@ -161,7 +186,44 @@ bool FSpout2MediaTextureSample::IsOutputSrgb() const
 	return true;
 }
 
-void FSpout2MediaTextureSample::ShutdownPoolable()
+//////////////////////////////////////////////////////////////////////////
+
+FSpout2MediaTextureSamplePool::FSpout2MediaTextureSamplePool(int32 InMaxSamples)
+	: MaxSamples(FMath::Max(InMaxSamples, 1))
 {
-	Destroy();
+	// Growing up to the cap never reallocates the array
+	Samples.Reserve(MaxSamples);
+}
+
+FSpout2MediaTextureSamplePool::FSamplePtr FSpout2MediaTextureSamplePool::AcquireShared()
+{
+	FScopeLock Lock(&SamplesLock);
+
+	for (const FSamplePtr& Sample : Samples)
+	{
+		if (Sample.GetSharedReferenceCount() == 1 && Sample->IsReadyForReuse())
+			return Sample;
+	}
+
+	if (Samples.Num() >= MaxSamples)
+		return nullptr;
+
+	INC_DWORD_STAT(STAT_Spout2Media_SamplesAllocated);
+	return Samples.Add_GetRef(MakeShared<FSpout2MediaTextureSample, ESPMode::ThreadSafe>());
+}
+
+void FSpout2MediaTextureSamplePool::Reset()
+{
+	FScopeLock Lock(&SamplesLock);
+
+	// A copy in flight still writes the texture, so its sample is kept until the fence passed.
+	// RemoveAll keeps the reserved capacity.
+	Samples.RemoveAll([](const FSamplePtr& Sample) { return Sample.GetSharedReferenceCount() == 1 && Sample->IsReadyForReuse(); });
+}
+
+int32 FSpout2MediaTextureSamplePool::Num() const
+{
+	FScopeLock Lock(&SamplesLock);
+
+	return Samples.Num();
 }
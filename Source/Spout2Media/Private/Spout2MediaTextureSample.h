@@ -4,7 +4,6 @@
 
 #include "CoreMinimal.h"
 #include "IMediaTextureSample.h"
-#include "MediaObjectPool.h"
 #include "RHI.h"
 #include "RHIUtilities.h"
 
@@ -13,16 +12,32 @@
 #include "Spout.h"
 #include "Windows/HideWindowsPlatformTypes.h"
 
+#include "SpoutCopyFence.h"
+
 class FSpout2MediaPlayer;
+class ISpoutReceiverBackend;
 
 class SPOUT2MEDIA_API FSpout2MediaTextureSample
 	: public IMediaTextureSample
-	, public IMediaPoolable
 {
 	FTexture2DRHIRef Texture;
 
-	FString RHIName;
+	// D3D11On12 view of Texture and the device it was created on
 	ID3D11Resource* WrappedDX11Resource = nullptr;
+	ID3D11On12Device* WrappedDevice = nullptr;
+
+	// Completion of the latest copy into Texture, set by the receiver backend
+	FSpoutCopyFence CopyFence;
+
+	// Size of Texture, tracked for the sample memory stat
+	SIZE_T TextureBytes = 0;
+
+	// When the frame was received and how long it is presented
+	FMediaTimeStamp Time;
+	FTimespan Duration;
+
+	// Frame number the sender gave the frame, 0 when it does not count frames
+	int64 SenderFrame = 0;
 	
 public:
 	
@@ -36,21 +51,32 @@ public:
 		DXGI_FORMAT DXFormat;
 		EPixelFormat PixelFormat;
 		
-		HANDLE SpoutSharehandle;
-
-		ID3D11DeviceContext* Context;
-		
-		ID3D11Device* D3D11Device;
-		ID3D12Device* D3D12Device;
-		ID3D11On12Device* D3D11on12Device;
+		// Backend of the receiver context, copies the opened sender texture into this sample
+		ISpoutReceiverBackend* Backend;
 
 		bool bSRGB;
 	} Args;
 	
-	void Initialize(const InitializeArguments& Args);
+	// Prepares the texture for Args and records the copy from the backend, on the render thread
+	bool Initialize(FRHICommandListImmediate& RHICmdList, const InitializeArguments& Args);
 	void Destroy();
 
-	void CopyResource(ID3D11Resource* SrcTexture);
+	// Whether the texture created for the current arguments can be reused for NewArgs
+	bool CanReuseTexture(const InitializeArguments& NewArgs) const;
+
+	void SetTime(const FMediaTimeStamp& InTime, FTimespan InDuration);
+
+	void SetSenderFrame(int64 InSenderFrame) { SenderFrame = InSenderFrame; }
+	int64 GetSenderFrame() const { return SenderFrame; }
+
+	// D3D11On12 view of the sample texture, created on first use for a device
+	ID3D11Resource* GetWrappedResource(ID3D11On12Device* D3D11on12Device);
+
+	// Fence the backend sets after recording the copy into the sample texture
+	FSpoutCopyFence& GetCopyFence() { return CopyFence; }
+
+	// Whether the GPU finished the copy, the sample is only handed out once it has
+	bool IsCopyComplete() const { return CopyFence.IsComplete(); }
 	
 public:
 	//~ IMediaTextureSample interface
@@ -65,7 +91,48 @@ public:
 	virtual bool IsCacheable() const override;
 	virtual bool IsOutputSrgb() const override;
 
+	// Whether the pool may hand the sample out again, the GPU may still be writing the texture
+	bool IsReadyForReuse() const { return IsCopyComplete(); }
+
+private:
+	void CreateTexture();
+	void ReleaseWrappedResource();
+};
+
+/**
+ * Pool of receive samples. Samples keep their texture (and on D3D12 the wrapped
+ * 11on12 resource) while they sit in the pool, so steady-state receiving does not
+ * allocate GPU memory.
+ *
+ * The pool keeps a shared reference to every sample it created and hands out copies of it.
+ * A sample is free again once the pool holds its only reference, so acquiring never allocates
+ * a reference controller the way TMediaObjectPool::AcquireShared does.
+ *
+ * The pool holds at most MaxSamples. Once all of them are in use, acquiring fails and the receiver
+ * drops the frame, so a consumer that stops fetching cannot grow it.
+ */
+class FSpout2MediaTextureSamplePool
+{
 public:
-	//~ IMediaPoolable interface
-	virtual void ShutdownPoolable() override;
+	using FSamplePtr = TSharedPtr<FSpout2MediaTextureSample, ESPMode::ThreadSafe>;
+
+	explicit FSpout2MediaTextureSamplePool(int32 InMaxSamples);
+
+	// Free sample whose last copy completed, created when none is free and the pool is not full.
+	// nullptr when all MaxSamples are in use. Called on the render thread.
+	FSamplePtr AcquireShared();
+
+	// Drops the free samples whose last copy completed. Samples still referenced elsewhere or still being
+	// copied into stay in the pool, to be acquired again or dropped by a later Reset.
+	void Reset();
+
+	// Samples created and not dropped yet, in use or free
+	int32 Num() const;
+
+private:
+	int32 MaxSamples;
+	TArray<FSamplePtr> Samples;
+
+	// Acquire runs on the render thread, Reset on the game thread
+	mutable FCriticalSection SamplesLock;
 };
@@ -0,0 +1,190 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Standard C++ only, so the protocol builds and runs headless on any platform.
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Index protocol of a multi-buffered Spout sender. The sender rotates through up to MaxBuffers shared
+ * textures and publishes the latest complete one, receivers in other processes read that one.
+ *
+ * FLayout sits in shared memory. Latest packs the sequence number of the published frame with the index
+ * of its buffer. A reader counts itself on a buffer in Readers, then checks the buffer is still the latest;
+ * the writer never picks the latest buffer or a buffer with readers. Both sides use sequentially consistent
+ * operations, so either the writer sees the reader's count or the reader sees the newer Latest and retries.
+ *
+ * Spout2MediaStandaloneTests/SpoutBufferIndexStressTest.cpp runs a writer against several readers.
+ */
+namespace SpoutBufferIndex
+{
+	static constexpr uint32_t MaxBuffers = 4;
+	static constexpr uint32_t NoBuffer = ~0u;
+
+	// Identifies an initialized layout
+	static constexpr uint32_t LayoutMagic = 0x53504d42; // 'SPMB'
+
+	inline uint64_t Pack(uint64_t Sequence, uint32_t Index) { return (Sequence << 8) | Index; }
+	inline uint32_t UnpackIndex(uint64_t Packed) { return uint32_t(Packed & 0xff); }
+	inline uint64_t UnpackSequence(uint64_t Packed) { return Packed >> 8; }
+
+	struct FLayout
+	{
+		// LayoutMagic once the writer initialized the rest
+		std::atomic<uint32_t> Magic;
+		uint32_t NumBuffers;
+
+		// Share handles of the textures, 32-bit like the handle in the Spout sender info
+		uint32_t Handles[MaxBuffers];
+
+		// Pack(Sequence, Index) of the latest complete buffer, 0 before the first frame
+		std::atomic<uint64_t> Latest;
+		std::atomic<uint32_t> Readers[MaxBuffers];
+	};
+
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "The layout is shared between processes");
+
+	// Clears the layout for NumBuffers buffers, the handles are filled in by the caller before Publish
+	inline void Initialize(FLayout& Layout, uint32_t NumBuffers)
+	{
+		Layout.Magic.store(0);
+		Layout.NumBuffers = NumBuffers;
+		Layout.Latest.store(0);
+
+		for (uint32_t Index = 0; Index < MaxBuffers; Index++)
+		{
+			Layout.Handles[Index] = 0;
+			Layout.Readers[Index].store(0);
+		}
+	}
+
+	inline void Publish(FLayout& Layout)
+	{
+		Layout.Magic.store(LayoutMagic);
+	}
+
+	inline bool IsValid(const FLayout& Layout)
+	{
+		return Layout.Magic.load() == LayoutMagic
+			&& Layout.NumBuffers > 0
+			&& Layout.NumBuffers <= MaxBuffers;
+	}
+
+	/**
+	 * Sender side. BeginWrite may run on another thread than EndWrite and AbortWrite,
+	 * but each of them on one thread only.
+	 */
+	class FWriter
+	{
+	public:
+		explicit FWriter(FLayout& InLayout)
+			: Layout(InLayout)
+		{
+		}
+
+		// Picks a buffer to render the next frame into, NoBuffer when every buffer is latest, read or written
+		uint32_t BeginWrite()
+		{
+			const uint32_t NumBuffers = Layout.NumBuffers;
+			const uint64_t Latest = Layout.Latest.load();
+			const uint32_t Writing = WritingMask.load();
+
+			for (uint32_t Offset = 0; Offset < NumBuffers; Offset++)
+			{
+				const uint32_t Index = (NextIndex + Offset) % NumBuffers;
+
+				if ((Writing & (1u << Index)) != 0)
+					continue;
+
+				if (Latest != 0 && Index == UnpackIndex(Latest))
+					continue;
+
+				if (Layout.Readers[Index].load() != 0)
+					continue;
+
+				WritingMask.fetch_or(1u << Index);
+				NextIndex = (Index + 1) % NumBuffers;
+				return Index;
+			}
+
+			return NoBuffer;
+		}
+
+		// Publishes the buffer once its frame is complete, returns the frame's sequence number
+		uint64_t EndWrite(uint32_t Index)
+		{
+			Layout.Latest.store(Pack(++Sequence, Index));
+			WritingMask.fetch_and(~(1u << Index));
+			return Sequence;
+		}
+
+		// Gives the buffer back without publishing it
+		void AbortWrite(uint32_t Index)
+		{
+			WritingMask.fetch_and(~(1u << Index));
+		}
+
+	private:
+		FLayout& Layout;
+
+		// Buffers picked by BeginWrite and not ended yet
+		std::atomic<uint32_t> WritingMask{0};
+
+		// Where BeginWrite starts looking, so buffers are used in turn
+		uint32_t NextIndex = 0;
+
+		uint64_t Sequence = 0;
+	};
+
+	/**
+	 * Receiver side. A reader holds its buffer from BeginRead until EndRead, i.e. until its copy completed.
+	 */
+	class FReader
+	{
+	public:
+		explicit FReader(FLayout& InLayout)
+			: Layout(InLayout)
+		{
+		}
+
+		// Counts the reader on the latest buffer. NoBuffer when nothing was published or the frame
+		// is not newer than AfterSequence, otherwise OutSequence is the frame's sequence number.
+		uint32_t BeginRead(uint64_t AfterSequence, uint64_t& OutSequence)
+		{
+			uint64_t Packed = Layout.Latest.load();
+
+			for (;;)
+			{
+				if (Packed == 0 || UnpackSequence(Packed) <= AfterSequence)
+					return NoBuffer;
+
+				const uint32_t Index = UnpackIndex(Packed);
+				if (Index >= Layout.NumBuffers)
+					return NoBuffer;
+
+				Layout.Readers[Index].fetch_add(1);
+
+				// Still the latest, the writer no longer picks it
+				const uint64_t Current = Layout.Latest.load();
+				if (UnpackIndex(Current) == Index)
+				{
+					OutSequence = UnpackSequence(Current);
+					return Index;
+				}
+
+				// The writer may have picked it meanwhile, try the newer one
+				Layout.Readers[Index].fetch_sub(1);
+				Packed = Current;
+			}
+		}
+
+		void EndRead(uint32_t Index)
+		{
+			Layout.Readers[Index].fetch_sub(1);
+		}
+
+	private:
+		FLayout& Layout;
+	};
+}
@@ -0,0 +1,169 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SpoutClockRecovery.h"
+
+#include "HAL/RunnableThread.h"
+
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include "Spout.h"
+#include "Windows/HideWindowsPlatformTypes.h"
+
+#include "Spout2MediaStats.h"
+#include "SpoutFrameSyncHelper.h"
+
+namespace
+{
+	// Arrivals within a quarter period of the prediction count towards lock
+	constexpr double LockTolerance = 0.25;
+	constexpr int32 MinLockArrivals = 16;
+
+	// Weight of each arrival in the reported drift
+	constexpr double DriftSmoothing = 0.01;
+
+	// Longest wait for a signal, senders that do not signal are seen by polling their frame counter this often
+	constexpr uint32 PollIntervalMs = 1;
+}
+
+double FSpoutClockRecovery::FEstimate::PredictArrivalAfter(double Time) const
+{
+	if (Period <= 0.0)
+		return Time;
+
+	if (Time < NextArrival)
+		return NextArrival;
+
+	return NextArrival + FMath::CeilToDouble((Time - NextArrival) / Period) * Period;
+}
+
+int64 FSpoutClockRecovery::FEstimate::PredictSenderFrame(double Time) const
+{
+	if (Period <= 0.0)
+		return SenderFrame;
+
+	return SenderFrame + FMath::RoundToInt64((Time - LastArrival) / Period);
+}
+
+FSpoutClockRecovery::FSpoutClockRecovery(const FString& InSenderName, const FString& InSyncSourceName, FFrameRate NominalFrameRate, float InBandwidthHz)
+	: SenderName(InSenderName)
+	, SyncSourceName(InSyncSourceName)
+	, NominalPeriod(NominalFrameRate.AsInterval())
+	, BandwidthHz(FMath::Max(InBandwidthHz, 0.01f))
+	, bStopping(false)
+{
+	Estimate.Period = NominalPeriod;
+
+	// Arrival times are only as good as the wake-up of this thread
+	Thread = FRunnableThread::Create(this, TEXT("SpoutClockRecovery"), 0, TPri_Highest);
+}
+
+FSpoutClockRecovery::~FSpoutClockRecovery()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+FSpoutClockRecovery::FEstimate FSpoutClockRecovery::GetEstimate() const
+{
+	FScopeLock Lock(&EstimateLock);
+	return Estimate;
+}
+
+uint32 FSpoutClockRecovery::Run()
+{
+	// A channel of its own, not the helper's: receivers keep every sender event to themselves
+	FSpoutFrameSyncChannel SyncChannel(SyncSourceName);
+	uint32 LastSequence = SyncChannel.GetSequence();
+	uint64 LastSignalledFrame = 0;
+
+	spoutFrameCount FrameCount;
+	FrameCount.EnableFrameCount(TCHAR_TO_ANSI(*SenderName));
+
+	int64 LastSenderFrame = 0;
+
+	while (!bStopping)
+	{
+		// Senders of this plugin signal when a frame reached receivers, others are seen by their frame counter
+		const uint32 PreviousSequence = LastSequence;
+		uint64 SignalledFrame = 0;
+		const bool bSignalled = SyncChannel.Observe(LastSequence, PollIntervalMs, &SignalledFrame);
+		const double Now = FPlatformTime::Seconds();
+
+		const bool bNewFrame = FrameCount.GetNewFrame();
+		const int64 SenderFrame = FrameCount.GetSenderFrame();
+
+		if (SenderFrame > 0)
+		{
+			// The counter tells how many frames passed, even when signals were coalesced
+			if (bNewFrame && SenderFrame > LastSenderFrame)
+			{
+				Update(Now, SenderFrame, LastSenderFrame > 0 ? SenderFrame - LastSenderFrame : 1);
+				LastSenderFrame = SenderFrame;
+			}
+		}
+		else if (bSignalled)
+		{
+			// No frame counter: the signalled frame number when the sender gives one, otherwise the number
+			// of signals, the sequence moves by two for each
+			const int64 FramesElapsed = SignalledFrame > LastSignalledFrame && LastSignalledFrame > 0
+				? int64(SignalledFrame - LastSignalledFrame)
+				: FMath::Max<int64>(int64(uint32(LastSequence - PreviousSequence) / 2), 1);
+
+			LastSignalledFrame = SignalledFrame;
+			LastSenderFrame += FramesElapsed;
+			Update(Now, LastSenderFrame, FramesElapsed);
+		}
+	}
+
+	FrameCount.CleanupFrameCount();
+	return 0;
+}
+
+void FSpoutClockRecovery::Stop()
+{
+	bStopping = true;
+}
+
+void FSpoutClockRecovery::Update(double ArrivalTime, int64 SenderFrame, int64 FramesElapsed)
+{
+	FScopeLock Lock(&EstimateLock);
+
+	// Delay-locked loop, see F. Adriaensen, "Using a DLL to filter time": the phase follows the error
+	// with gain B, the period integrates it with gain C, for a critically damped loop of BandwidthHz
+	const double Omega = 2.0 * PI * BandwidthHz * NominalPeriod;
+	const double B = UE_SQRT_2 * Omega;
+	const double C = Omega * Omega;
+
+	const double Predicted = Estimate.NextArrival + (FramesElapsed - 1) * Estimate.Period;
+	const double Error = ArrivalTime - Predicted;
+
+	// First arrival, or lost track of the sender: start over from the nominal rate
+	if (Estimate.NextArrival <= 0.0 || FMath::Abs(Error) > Estimate.Period * FramesElapsed)
+	{
+		Estimate.Period = NominalPeriod;
+		Estimate.NextArrival = ArrivalTime + NominalPeriod;
+		Estimate.LastArrival = ArrivalTime;
+		Estimate.SenderFrame = SenderFrame;
+		Estimate.bLocked = false;
+		NumMatchedArrivals = 0;
+		return;
+	}
+
+	Estimate.LastArrival = Predicted + B * Error;
+	Estimate.NextArrival = Estimate.LastArrival + Estimate.Period;
+	Estimate.Period += C * Error / FramesElapsed;
+	Estimate.SenderFrame = SenderFrame;
+
+	// The period follows arrival jitter within the loop bandwidth, the reported drift is averaged further
+	const double PeriodDriftPpm = (Estimate.Period - NominalPeriod) / NominalPeriod * 1e6;
+	Estimate.DriftPpm = FMath::Lerp(Estimate.DriftPpm, PeriodDriftPpm, DriftSmoothing);
+
+	NumMatchedArrivals = FMath::Abs(Error) < Estimate.Period * LockTolerance ? NumMatchedArrivals + 1 : 0;
+	Estimate.bLocked = NumMatchedArrivals >= MinLockArrivals;
+
+	SET_FLOAT_STAT(STAT_Spout2Media_ClockDrift, Estimate.DriftPpm);
+	SET_FLOAT_STAT(STAT_Spout2Media_ClockPhaseError, Error * 1000.0);
+}
@@ -0,0 +1,74 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Misc/FrameRate.h"
+
+class FRunnableThread;
+
+/**
+ * Recovers a sender's frame clock on a background thread. Each sender frame arrival, seen through the
+ * sender's shared frame signal or its Spout frame counter, updates a second order delay-locked loop tracking
+ * the frame period and the phase of the next arrival. Consumers read the estimate without blocking.
+ *
+ * Arrivals are observed, never taken: the sender's auto-reset event is left to the player and time step
+ * waits, so running the clock does not steal their wake-ups.
+ */
+class FSpoutClockRecovery
+	: public FRunnable
+{
+public:
+	struct FEstimate
+	{
+		// Enough consecutive arrivals matched the prediction
+		bool bLocked = false;
+
+		// Filtered frame period and arrival times, in FPlatformTime::Seconds
+		double Period = 0.0;
+		double LastArrival = 0.0;
+		double NextArrival = 0.0;
+
+		// Period against the nominal frame rate, positive when the sender runs slow
+		double DriftPpm = 0.0;
+
+		// Sender frame counter at LastArrival
+		int64 SenderFrame = 0;
+
+		// Predicted arrival of the first sender frame after Time
+		double PredictArrivalAfter(double Time) const;
+
+		// Sender frame counter predicted at Time
+		int64 PredictSenderFrame(double Time) const;
+	};
+
+	// SenderName is the Spout sender, SyncSourceName the name its sync channel was created with
+	FSpoutClockRecovery(const FString& SenderName, const FString& SyncSourceName, FFrameRate NominalFrameRate, float BandwidthHz);
+	virtual ~FSpoutClockRecovery() override;
+
+	const FString& GetSenderName() const { return SenderName; }
+
+	FEstimate GetEstimate() const;
+
+	//~ FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	// Feeds one observed arrival, FramesElapsed sender frames after the previous one
+	void Update(double ArrivalTime, int64 SenderFrame, int64 FramesElapsed);
+
+	FString SenderName;
+	FString SyncSourceName;
+	double NominalPeriod;
+	float BandwidthHz;
+
+	// Loop state, written on the clock thread under EstimateLock
+	mutable FCriticalSection EstimateLock;
+	FEstimate Estimate;
+	int32 NumMatchedArrivals = 0;
+
+	FRunnableThread* Thread = nullptr;
+	TAtomic<bool> bStopping;
+};
@@ -0,0 +1,75 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SpoutCopyFence.h"
+
+#include "RHICommandList.h"
+
+void FSpoutCopyFence::WriteRHI(FRHICommandList& RHICmdList)
+{
+	RHICmdList.WriteGPUFence(BeginRHI());
+}
+
+FRHIGPUFence* FSpoutCopyFence::BeginRHI()
+{
+	D3D11Fence.SafeRelease();
+	D3D11FenceValue = 0;
+
+	if (!RHIFence)
+	{
+		RHIFence = RHICreateGPUFence(TEXT("SpoutCopyFence"));
+	}
+
+	RHIFence->Clear();
+	return RHIFence;
+}
+
+void FSpoutCopyFence::SetD3D11(ID3D11Fence* Fence, uint64 Value)
+{
+	D3D11Fence = Fence;
+	D3D11FenceValue = Value;
+}
+
+bool FSpoutCopyFence::IsComplete() const
+{
+	if (D3D11Fence)
+		return D3D11Fence->GetCompletedValue() >= D3D11FenceValue;
+
+	if (RHIFence)
+		return RHIFence->Poll();
+
+	return true;
+}
+
+void FSpoutCopyFence::Reset()
+{
+	D3D11Fence.SafeRelease();
+	D3D11FenceValue = 0;
+
+	if (RHIFence)
+	{
+		RHIFence->Clear();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool FSpoutD3D11FenceSource::Initialize(ID3D11Device* Device, ID3D11DeviceContext* Context)
+{
+	TRefCountPtr<ID3D11Device5> Device5;
+	if (Device->QueryInterface(IID_PPV_ARGS(Device5.GetInitReference())) != S_OK)
+		return false;
+
+	if (Context->QueryInterface(IID_PPV_ARGS(Context4.GetInitReference())) != S_OK)
+		return false;
+
+	LastValue = 0;
+	return Device5->CreateFence(LastValue, D3D11_FENCE_FLAG_NONE, IID_PPV_ARGS(Fence.GetInitReference())) == S_OK;
+}
+
+void FSpoutD3D11FenceSource::Signal(FSpoutCopyFence& OutFence)
+{
+	check(IsValid());
+
+	Context4->Signal(Fence, ++LastValue);
+	OutFence.SetD3D11(Fence, LastValue);
+}
@@ -0,0 +1,54 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI.h"
+#include "RHIResources.h"
+
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <d3d11_4.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+
+class FRHICommandList;
+
+/**
+ * Completion of one GPU copy. Copies recorded on the RHI command list complete through an RHI fence,
+ * copies submitted on a D3D11 (or D3D11On12) device through a D3D11 fence value.
+ * Polling never blocks.
+ */
+struct FSpoutCopyFence
+{
+	FGPUFenceRHIRef RHIFence;
+
+	TRefCountPtr<ID3D11Fence> D3D11Fence;
+	uint64 D3D11FenceValue = 0;
+
+	// Clears the fence and writes it after the commands already recorded on RHICmdList
+	void WriteRHI(FRHICommandList& RHICmdList);
+
+	// Clears the fence and returns the RHI fence for the caller to write later, e.g. from a render graph pass
+	FRHIGPUFence* BeginRHI();
+
+	// Tracks a value signalled on a D3D11 context
+	void SetD3D11(ID3D11Fence* Fence, uint64 Value);
+
+	bool IsComplete() const;
+	void Reset();
+};
+
+/**
+ * Monotonic D3D11 fence signalled on one device context, used where a copy does not go through the RHI.
+ */
+struct FSpoutD3D11FenceSource
+{
+	TRefCountPtr<ID3D11Fence> Fence;
+	TRefCountPtr<ID3D11DeviceContext4> Context4;
+	uint64 LastValue = 0;
+
+	bool Initialize(ID3D11Device* Device, ID3D11DeviceContext* Context);
+	bool IsValid() const { return Fence.IsValid() && Context4.IsValid(); }
+
+	// Signals the next value on the context and points OutFence at it
+	void Signal(FSpoutCopyFence& OutFence);
+};
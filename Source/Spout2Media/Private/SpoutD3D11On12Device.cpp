@@ -0,0 +1,155 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SpoutD3D11On12Device.h"
+
+#include "RHI.h"
+#include "Spout2MediaStats.h"
+
+namespace
+{
+	FCriticalSection SharedDeviceLock;
+	TWeakPtr<FSpoutD3D11On12Device, ESPMode::ThreadSafe> SharedDevice;
+}
+
+TSharedPtr<FSpoutD3D11On12Device, ESPMode::ThreadSafe> FSpoutD3D11On12Device::Get()
+{
+	FScopeLock Lock(&SharedDeviceLock);
+
+	TSharedPtr<FSpoutD3D11On12Device, ESPMode::ThreadSafe> Device = SharedDevice.Pin();
+	if (!Device)
+	{
+		Device = MakeShared<FSpoutD3D11On12Device, ESPMode::ThreadSafe>();
+		SharedDevice = Device;
+	}
+
+	return Device;
+}
+
+void FSpoutD3D11On12Device::FlushRequested()
+{
+	TSharedPtr<FSpoutD3D11On12Device, ESPMode::ThreadSafe> Device;
+	{
+		FScopeLock Lock(&SharedDeviceLock);
+		Device = SharedDevice.Pin();
+	}
+
+	// Submits without waiting, completion of each copy is tracked by its fence
+	if (Device && Device->bFlushRequested.exchange(false))
+	{
+		FScopeLock Lock(&Device->ContextLock);
+		Device->DeviceContext->Flush();
+	}
+}
+
+FSpoutD3D11On12Device::FSpoutD3D11On12Device()
+{
+	ID3D12Device* D3D12Device = static_cast<ID3D12Device*>(GDynamicRHI->RHIGetNativeDevice());
+	UINT DeviceFlags11 = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
+
+	verify(D3D11On12CreateDevice(
+		D3D12Device,
+		DeviceFlags11,
+		nullptr,
+		0,
+		nullptr,
+		0,
+		0,
+		D3D11Device.GetInitReference(),
+		DeviceContext.GetInitReference(),
+		nullptr
+	) == S_OK);
+
+	verify(D3D11Device->QueryInterface(__uuidof(ID3D11On12Device), (void**)D3D11on12Device.GetInitReference()) == S_OK);
+	verify(CopyFenceSource.Initialize(D3D11Device, DeviceContext));
+}
+
+FSpoutD3D11On12Device::~FSpoutD3D11On12Device()
+{
+	// Copies recorded after the last end of frame still have to reach the GPU
+	if (DeviceContext)
+	{
+		DeviceContext->Flush();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+FSpoutWrappedResourceCache::FSpoutWrappedResourceCache(int32 InCapacity)
+	: Capacity(FMath::Max(InCapacity, 1))
+{
+	Entries.Reserve(Capacity);
+}
+
+FSpoutWrappedResourceCache::~FSpoutWrappedResourceCache()
+{
+	Reset();
+}
+
+ID3D11Resource* FSpoutWrappedResourceCache::FindOrWrap(ID3D11On12Device* Device, FRHITexture* Texture,
+	D3D12_RESOURCE_STATES InState, D3D12_RESOURCE_STATES OutState)
+{
+	for (int32 Index = 0; Index < Entries.Num(); Index++)
+	{
+		if (Entries[Index].Texture == Texture)
+		{
+			INC_DWORD_STAT(STAT_Spout2Media_WrappedResourceHits);
+
+			if (Index > 0)
+			{
+				FEntry Entry = MoveTemp(Entries[Index]);
+				Entries.RemoveAt(Index);
+				Entries.Insert(MoveTemp(Entry), 0);
+			}
+
+			return Entries[0].Wrapped;
+		}
+	}
+
+	INC_DWORD_STAT(STAT_Spout2Media_WrappedResourceMisses);
+
+	if (Entries.Num() == Capacity)
+	{
+		RemoveEntry(Entries.Num() - 1);
+	}
+
+	FEntry Entry;
+	Entry.Texture = Texture;
+
+	D3D11_RESOURCE_FLAGS rf11 = {};
+	if (Device->CreateWrappedResource(
+		static_cast<ID3D12Resource*>(Texture->GetNativeResource()), &rf11,
+		InState, OutState, __uuidof(ID3D11Resource),
+		(void**)Entry.Wrapped.GetInitReference()) != S_OK)
+	{
+		return nullptr;
+	}
+
+	INC_DWORD_STAT(STAT_Spout2Media_WrappedResources);
+	Entries.Insert(MoveTemp(Entry), 0);
+	return Entries[0].Wrapped;
+}
+
+void FSpoutWrappedResourceCache::EvictReleased()
+{
+	for (int32 Index = Entries.Num() - 1; Index >= 0; Index--)
+	{
+		if (Entries[Index].Texture->GetRefCount() == 1)
+		{
+			RemoveEntry(Index);
+		}
+	}
+}
+
+void FSpoutWrappedResourceCache::Reset()
+{
+	while (Entries.Num() > 0)
+	{
+		RemoveEntry(Entries.Num() - 1);
+	}
+}
+
+void FSpoutWrappedResourceCache::RemoveEntry(int32 Index)
+{
+	DEC_DWORD_STAT(STAT_Spout2Media_WrappedResources);
+	Entries.RemoveAt(Index);
+}
@@ -0,0 +1,88 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHIResources.h"
+#include "SpoutCopyFence.h"
+
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <d3d11on12.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+
+#include <atomic>
+
+/**
+ * D3D11On12 device and immediate context shared by every Spout receiver and sender on the D3D12 RHI.
+ * Created by the first user and released with the last one. Receivers record copies on the render thread,
+ * submitted together by one Flush at the end of the render thread frame; senders copy on the send thread.
+ */
+class FSpoutD3D11On12Device
+{
+public:
+	// Shared device, created on first use. Safe to call from any thread.
+	static TSharedPtr<FSpoutD3D11On12Device, ESPMode::ThreadSafe> Get();
+
+	// Submits the copies recorded since the last flush, bound to the end of the render thread frame
+	static void FlushRequested();
+
+	FSpoutD3D11On12Device();
+	~FSpoutD3D11On12Device();
+
+	ID3D11Device* GetDevice() const { return D3D11Device; }
+	ID3D11DeviceContext* GetContext() const { return DeviceContext; }
+	ID3D11On12Device* GetOn12Device() const { return D3D11on12Device; }
+
+	// Fence signalled after copies on the shared context
+	FSpoutD3D11FenceSource& GetFenceSource() { return CopyFenceSource; }
+
+	// Held while using the context or the fence source, the render thread and the send thread share them
+	FCriticalSection& GetContextLock() { return ContextLock; }
+
+	// Asks for the work recorded on the context to be submitted at the end of the frame
+	void RequestFlush() { bFlushRequested = true; }
+
+private:
+	TRefCountPtr<ID3D11Device> D3D11Device;
+	TRefCountPtr<ID3D11DeviceContext> DeviceContext;
+	TRefCountPtr<ID3D11On12Device> D3D11on12Device;
+
+	FSpoutD3D11FenceSource CopyFenceSource;
+	FCriticalSection ContextLock;
+
+	std::atomic<bool> bFlushRequested{false};
+};
+
+/**
+ * Bounded LRU of D3D11On12 views of RHI textures. Entries whose texture nothing else references
+ * any more are evicted by EvictReleased, the least recently used one when a new texture does not fit.
+ */
+class FSpoutWrappedResourceCache
+{
+public:
+	explicit FSpoutWrappedResourceCache(int32 InCapacity = 4);
+	~FSpoutWrappedResourceCache();
+
+	// View of Texture on Device, wrapped on first use with the given D3D12 states
+	ID3D11Resource* FindOrWrap(ID3D11On12Device* Device, FRHITexture* Texture,
+		D3D12_RESOURCE_STATES InState, D3D12_RESOURCE_STATES OutState);
+
+	// Drops the views of textures only the cache still references
+	void EvictReleased();
+
+	void Reset();
+	int32 Num() const { return Entries.Num(); }
+
+private:
+	struct FEntry
+	{
+		FTextureRHIRef Texture;
+		TRefCountPtr<ID3D11Resource> Wrapped;
+	};
+
+	void RemoveEntry(int32 Index);
+
+	// Most recently used first
+	TArray<FEntry> Entries;
+	int32 Capacity;
+};
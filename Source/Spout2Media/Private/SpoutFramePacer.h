@@ -0,0 +1,189 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Standard C++ only, so the pacer builds and runs headless on any platform.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+/**
+ * Paces frames against absolute deadlines. Frame N is due at Start + N * Denominator / Numerator seconds,
+ * computed in integer nanoseconds, so rational rates such as 60000/1001 never drift. A late frame does not
+ * move the following deadlines; falling behind by more than a frame skips the missed deadlines instead of
+ * sending a burst to catch up.
+ *
+ * Each completed frame records its jitter, how late it was against its deadline.
+ * Spout2MediaStandaloneTests/SpoutFramePacerJitterBenchmark.cpp prints its distribution on this machine.
+ */
+class FSpoutFramePacer
+{
+public:
+	using FClock = std::chrono::steady_clock;
+
+	struct FJitterStats
+	{
+		int64_t NumFrames = 0;
+		int64_t NumMissedFrames = 0;
+		std::chrono::nanoseconds Last{0};
+		std::chrono::nanoseconds Max{0};
+		double SumMs = 0.0;
+		double SumSquaresMs = 0.0;
+
+		double GetMeanMs() const { return NumFrames > 0 ? SumMs / NumFrames : 0.0; }
+
+		double GetStdDevMs() const
+		{
+			if (NumFrames < 2)
+				return 0.0;
+
+			const double Mean = GetMeanMs();
+			return std::sqrt(std::max(0.0, SumSquaresMs / NumFrames - Mean * Mean));
+		}
+	};
+
+	// Sleeping stops this long before a deadline and the rest is spun, OS sleeps overshoot by up to a timer period
+	std::chrono::nanoseconds SpinThreshold = std::chrono::microseconds(1500);
+
+	// Numerator <= 0 turns pacing off, every frame is then due. Restarts the schedule when the rate changed.
+	void SetFrameRate(int64_t InNumerator, int64_t InDenominator)
+	{
+		if (InNumerator == Numerator && InDenominator == Denominator)
+			return;
+
+		Numerator = InNumerator;
+		Denominator = InDenominator > 0 ? InDenominator : 1;
+		bStarted = false;
+	}
+
+	bool IsPaced() const { return Numerator > 0; }
+
+	// Starts the schedule over, the next frame is due right away
+	void Restart() { bStarted = false; }
+
+	// Non-blocking, for callers that cannot wait. Whether the next frame is due; if it is, the frame counts as sent.
+	bool IsFrameDue(FClock::time_point Now = FClock::now())
+	{
+		if (!IsPaced() || !bStarted)
+		{
+			Begin(Now);
+			return true;
+		}
+
+		const FClock::time_point Deadline = GetDeadline(FrameIndex);
+		if (Now < Deadline)
+			return false;
+
+		Complete(Now, Deadline);
+		return true;
+	}
+
+	// Blocks until the next frame is due, sleeping first and spinning for the last SpinThreshold
+	void WaitForNextFrame()
+	{
+		if (!IsPaced() || !bStarted)
+		{
+			Begin(FClock::now());
+			return;
+		}
+
+		const FClock::time_point Deadline = GetDeadline(FrameIndex);
+		FClock::time_point Now = FClock::now();
+
+		if (Deadline - Now > SpinThreshold)
+		{
+			std::this_thread::sleep_until(Deadline - SpinThreshold);
+			Now = FClock::now();
+		}
+
+		while (Now < Deadline)
+		{
+			std::this_thread::yield();
+			Now = FClock::now();
+		}
+
+		Complete(Now, Deadline);
+	}
+
+	// Deadline of frame Index of the current schedule
+	FClock::time_point GetDeadline(int64_t Index) const
+	{
+		// Index * Denominator / Numerator seconds, split so the nanoseconds do not overflow
+		const int64_t Ticks = Index * Denominator;
+		const int64_t Seconds = Ticks / Numerator;
+		const int64_t Remainder = Ticks % Numerator;
+
+		return Start + std::chrono::nanoseconds(Seconds * NanosecondsPerSecond + Remainder * NanosecondsPerSecond / Numerator);
+	}
+
+	const FJitterStats& GetJitterStats() const { return Stats; }
+	void ResetJitterStats() { Stats = FJitterStats(); }
+
+	// Deadlines skipped by the last completed frame
+	int64_t GetLastMissedFrames() const { return LastMissedFrames; }
+
+private:
+	static constexpr int64_t NanosecondsPerSecond = 1000000000;
+
+	void Begin(FClock::time_point Now)
+	{
+		Start = Now;
+		FrameIndex = 1;
+		bStarted = true;
+
+		LastMissedFrames = 0;
+		Record(std::chrono::nanoseconds(0));
+	}
+
+	void Complete(FClock::time_point Now, FClock::time_point Deadline)
+	{
+		// Next frame is the first one whose deadline has not passed yet
+		int64_t NextIndex = FrameIndex + 1;
+		if (GetDeadline(NextIndex) <= Now)
+		{
+			const double Elapsed = std::chrono::duration<double>(Now - Start).count();
+			NextIndex = std::max(NextIndex, int64_t(Elapsed * double(Numerator) / double(Denominator)));
+
+			while (NextIndex > FrameIndex + 1 && GetDeadline(NextIndex - 1) > Now)
+			{
+				NextIndex--;
+			}
+
+			while (GetDeadline(NextIndex) <= Now)
+			{
+				NextIndex++;
+			}
+		}
+
+		LastMissedFrames = NextIndex - FrameIndex - 1;
+		Stats.NumMissedFrames += LastMissedFrames;
+		FrameIndex = NextIndex;
+
+		Record(std::chrono::duration_cast<std::chrono::nanoseconds>(Now - Deadline));
+	}
+
+	void Record(std::chrono::nanoseconds Jitter)
+	{
+		const double JitterMs = std::chrono::duration<double, std::milli>(Jitter).count();
+
+		Stats.NumFrames++;
+		Stats.Last = Jitter;
+		Stats.Max = std::max(Stats.Max, Jitter);
+		Stats.SumMs += JitterMs;
+		Stats.SumSquaresMs += JitterMs * JitterMs;
+	}
+
+	int64_t Numerator = 0;
+	int64_t Denominator = 1;
+
+	bool bStarted = false;
+	FClock::time_point Start;
+
+	// Frame whose deadline is next
+	int64_t FrameIndex = 0;
+	int64_t LastMissedFrames = 0;
+
+	FJitterStats Stats;
+};
@@ -0,0 +1,277 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Standard C++ only, so the ring builds and runs headless on any platform.
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * CPU frame transport over a block of shared memory: one writer, any number of readers in any process,
+ * no locks and no waiting on either side.
+ *
+ * The block holds an FRingHeader followed by NumSlots slots, each an FSlotHeader and SlotCapacity bytes of
+ * pixels. Frame N goes to slot (N - 1) % NumSlots and Latest is set to N once the frame is complete.
+ * Each slot is a sequence lock: its Sequence is odd while the writer fills it. A reader copies the slot and
+ * keeps the copy only if Sequence was even and unchanged around it, otherwise the writer lapped it and it
+ * retries on the newer frame. The writer never waits for readers, slow readers skip frames instead.
+ *
+ * Spout2MediaStandaloneTests/SpoutFrameRingLoadTest.cpp runs a ring in FSpoutSharedMemory with reader processes.
+ */
+namespace SpoutFrameRing
+{
+	static constexpr uint32_t MaxSlots = 16;
+
+	// Identifies an initialized ring
+	static constexpr uint32_t RingMagic = 0x53504652; // 'SPFR'
+
+	// Slots and pixel rows start on cache lines
+	static constexpr size_t Alignment = 64;
+
+	inline size_t Align(size_t Size) { return (Size + Alignment - 1) & ~(Alignment - 1); }
+
+	// Description of one frame, PixelFormat is opaque to the ring
+	struct FFrameInfo
+	{
+		uint64_t FrameNumber = 0;
+		int64_t TimestampNs = 0;
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		uint32_t Stride = 0;
+		uint32_t PixelFormat = 0;
+		uint32_t Size = 0;
+	};
+
+	struct alignas(Alignment) FRingHeader
+	{
+		// RingMagic once the writer initialized the rest
+		std::atomic<uint32_t> Magic;
+		uint32_t NumSlots;
+		uint64_t SlotCapacity;
+
+		// Number of the latest complete frame, 0 before the first one
+		std::atomic<uint64_t> Latest;
+	};
+
+	// Fields are atomics so readers racing the writer stay well defined, the sequence lock decides what is kept
+	struct alignas(Alignment) FSlotHeader
+	{
+		std::atomic<uint64_t> Sequence;
+		std::atomic<uint64_t> FrameNumber;
+		std::atomic<int64_t> TimestampNs;
+		std::atomic<uint32_t> Width;
+		std::atomic<uint32_t> Height;
+		std::atomic<uint32_t> Stride;
+		std::atomic<uint32_t> PixelFormat;
+		std::atomic<uint32_t> Size;
+	};
+
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "The ring is shared between processes");
+
+	inline size_t GetSlotStride(uint64_t SlotCapacity) { return sizeof(FSlotHeader) + Align(size_t(SlotCapacity)); }
+
+	// Bytes of shared memory a ring needs
+	inline size_t GetRequiredSize(uint32_t NumSlots, uint64_t SlotCapacity)
+	{
+		return sizeof(FRingHeader) + size_t(NumSlots) * GetSlotStride(SlotCapacity);
+	}
+
+	inline FSlotHeader& GetSlot(FRingHeader& Header, uint32_t Index)
+	{
+		uint8_t* Slots = reinterpret_cast<uint8_t*>(&Header) + sizeof(FRingHeader);
+		return *reinterpret_cast<FSlotHeader*>(Slots + Index * GetSlotStride(Header.SlotCapacity));
+	}
+
+	inline uint8_t* GetSlotData(FSlotHeader& Slot) { return reinterpret_cast<uint8_t*>(&Slot) + sizeof(FSlotHeader); }
+
+	// Clears Memory, at least GetRequiredSize bytes, and publishes the ring
+	inline FRingHeader& Initialize(void* Memory, uint32_t NumSlots, uint64_t SlotCapacity)
+	{
+		FRingHeader& Header = *static_cast<FRingHeader*>(Memory);
+		Header.Magic.store(0);
+		Header.NumSlots = NumSlots < 1 ? 1 : (NumSlots > MaxSlots ? MaxSlots : NumSlots);
+		Header.SlotCapacity = SlotCapacity;
+		Header.Latest.store(0);
+
+		for (uint32_t Index = 0; Index < Header.NumSlots; Index++)
+		{
+			FSlotHeader& Slot = GetSlot(Header, Index);
+			Slot.Sequence.store(0);
+			Slot.FrameNumber.store(0);
+			Slot.Size.store(0);
+		}
+
+		Header.Magic.store(RingMagic);
+		return Header;
+	}
+
+	// Whether Memory, MemorySize bytes long, holds an initialized ring that fits in it
+	inline bool IsValid(const void* Memory, size_t MemorySize)
+	{
+		if (MemorySize < sizeof(FRingHeader))
+			return false;
+
+		const FRingHeader& Header = *static_cast<const FRingHeader*>(Memory);
+		return Header.Magic.load() == RingMagic
+			&& Header.NumSlots > 0
+			&& Header.NumSlots <= MaxSlots
+			&& GetRequiredSize(Header.NumSlots, Header.SlotCapacity) <= MemorySize;
+	}
+
+	/**
+	 * Writer side, one per ring. BeginWrite hands out the slot memory so frames can be written in place.
+	 */
+	class FWriter
+	{
+	public:
+		explicit FWriter(FRingHeader& InHeader)
+			: Header(InHeader)
+			, FrameNumber(InHeader.Latest.load())
+		{
+		}
+
+		uint64_t GetSlotCapacity() const { return Header.SlotCapacity; }
+
+		// Pixels of the next frame go here, at most GetSlotCapacity bytes. Calling it again before EndWrite
+		// hands out the same slot.
+		uint8_t* BeginWrite()
+		{
+			FSlotHeader& Slot = GetSlot(Header, uint32_t(FrameNumber % Header.NumSlots));
+
+			// Odd while writing, readers that saw the previous value throw their copy away
+			if (!bWriting)
+			{
+				Slot.Sequence.store(Slot.Sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+				bWriting = true;
+			}
+
+			return GetSlotData(Slot);
+		}
+
+		// Completes the frame begun last, returns its number
+		uint64_t EndWrite(const FFrameInfo& Info)
+		{
+			if (!bWriting)
+				BeginWrite();
+
+			bWriting = false;
+			const uint64_t Number = ++FrameNumber;
+			FSlotHeader& Slot = GetSlot(Header, uint32_t((Number - 1) % Header.NumSlots));
+
+			Slot.FrameNumber.store(Number, std::memory_order_relaxed);
+			Slot.TimestampNs.store(Info.TimestampNs, std::memory_order_relaxed);
+			Slot.Width.store(Info.Width, std::memory_order_relaxed);
+			Slot.Height.store(Info.Height, std::memory_order_relaxed);
+			Slot.Stride.store(Info.Stride, std::memory_order_relaxed);
+			Slot.PixelFormat.store(Info.PixelFormat, std::memory_order_relaxed);
+			Slot.Size.store(Info.Size <= Header.SlotCapacity ? Info.Size : uint32_t(Header.SlotCapacity), std::memory_order_relaxed);
+
+			Slot.Sequence.store(Slot.Sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			Header.Latest.store(Number, std::memory_order_release);
+			return Number;
+		}
+
+		// Copies a whole frame in, false when it does not fit a slot
+		bool Write(FFrameInfo Info, const void* Data)
+		{
+			if (Info.Size > Header.SlotCapacity)
+				return false;
+
+			std::memcpy(BeginWrite(), Data, Info.Size);
+			EndWrite(Info);
+			return true;
+		}
+
+	private:
+		FRingHeader& Header;
+
+		// Number of the last frame written
+		uint64_t FrameNumber = 0;
+
+		// Between BeginWrite and EndWrite, the slot's sequence is odd
+		bool bWriting = false;
+	};
+
+	enum class EReadResult : uint8_t
+	{
+		// Got a frame newer than the one asked about
+		Ok,
+		// Nothing newer was published
+		NoNewFrame,
+		// The frame does not fit the destination, OutInfo tells its size
+		TooLarge,
+		// The writer kept lapping the reader, try again later
+		Overrun,
+	};
+
+	/**
+	 * Reader side, any number of them per ring, each used from one thread.
+	 */
+	class FReader
+	{
+	public:
+		explicit FReader(FRingHeader& InHeader)
+			: Header(InHeader)
+		{
+		}
+
+		uint64_t GetLatestFrameNumber() const { return Header.Latest.load(std::memory_order_acquire); }
+
+		// Copies the latest frame if it is newer than AfterFrame
+		EReadResult ReadLatest(uint64_t AfterFrame, FFrameInfo& OutInfo, void* Dest, size_t DestCapacity, uint32_t MaxAttempts = 4)
+		{
+			for (uint32_t Attempt = 0; Attempt < MaxAttempts; Attempt++)
+			{
+				const uint64_t Latest = Header.Latest.load(std::memory_order_acquire);
+				if (Latest == 0 || Latest <= AfterFrame)
+					return EReadResult::NoNewFrame;
+
+				FSlotHeader& Slot = GetSlot(Header, uint32_t((Latest - 1) % Header.NumSlots));
+
+				const uint64_t SequenceBefore = Slot.Sequence.load(std::memory_order_acquire);
+				if (SequenceBefore & 1)
+					continue;
+
+				FFrameInfo Info;
+				Info.FrameNumber = Slot.FrameNumber.load(std::memory_order_relaxed);
+				Info.TimestampNs = Slot.TimestampNs.load(std::memory_order_relaxed);
+				Info.Width = Slot.Width.load(std::memory_order_relaxed);
+				Info.Height = Slot.Height.load(std::memory_order_relaxed);
+				Info.Stride = Slot.Stride.load(std::memory_order_relaxed);
+				Info.PixelFormat = Slot.PixelFormat.load(std::memory_order_relaxed);
+				Info.Size = Slot.Size.load(std::memory_order_relaxed);
+
+				if (Info.Size > Header.SlotCapacity)
+					continue;
+
+				if (Info.Size > DestCapacity)
+				{
+					OutInfo = Info;
+					return EReadResult::TooLarge;
+				}
+
+				// May race the writer, in which case the sequence check below throws the copy away
+				std::memcpy(Dest, GetSlotData(Slot), Info.Size);
+
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (Slot.Sequence.load(std::memory_order_relaxed) != SequenceBefore)
+					continue;
+
+				// Lapped between reading Latest and the slot, the slot already holds a newer frame
+				if (Info.FrameNumber <= AfterFrame)
+					return EReadResult::NoNewFrame;
+
+				OutInfo = Info;
+				return EReadResult::Ok;
+			}
+
+			return EReadResult::Overrun;
+		}
+
+	private:
+		FRingHeader& Header;
+	};
+}
@@ -0,0 +1,163 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Standard C++ plus the futex system call on Linux, so the signal builds and runs headless.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Frame signal of one sender in shared memory. The sender bumps Sequence and stores the number of the
+ * frame with each signal; a waiter remembers the last sequence it saw and waits until it changes.
+ * Every waiter wakes and learns the number of the latest frame, unlike an auto-reset event that wakes
+ * one waiter and carries nothing. Signals closer together than a waiter wakes up are seen as one.
+ *
+ * Sequence is a sequence lock around FrameNumber: odd while a signal stores the frame number, even once
+ * it is published, so a waiter never pairs a sequence with the frame number of the signal after it.
+ *
+ * FLayout is valid zero-filled, so either side may create the memory first. On Linux waiters sleep on
+ * Sequence with a futex, woken only when someone waits. Elsewhere the signal only carries the frame
+ * number and waiters poll, callers there block on the platform's named event instead.
+ *
+ * Both sides of a signal pass the same EScope, see there.
+ * Spout2MediaStandaloneTests/SpoutFrameSignalBenchmark.cpp measures wake latency and throughput per scope.
+ */
+namespace SpoutFrameSignal
+{
+	struct FLayout
+	{
+		// Futex word, bumped twice by each signal, odd while FrameNumber is written
+		std::atomic<uint32_t> Sequence;
+
+		// Waiters sleeping on Sequence, the sender skips the wake system call without any
+		std::atomic<uint32_t> NumWaiters;
+
+		// Frame number passed to the latest signal
+		std::atomic<uint64_t> FrameNumber;
+	};
+
+	static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Sequence is used as a futex word");
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "The layout is shared between processes");
+
+	// Who can see the layout. Signal and Wait on one layout must agree: Linux keys process private futexes
+	// by address and shared ones by the mapped memory, so a wake of the other kind never reaches a waiter.
+	enum class EScope : uint8_t
+	{
+		// Layout in memory of this process only, waits use the cheaper FUTEX_*_PRIVATE operations
+		Process,
+		// Layout in shared memory other processes map, like every layout of this plugin so far
+		Shared,
+	};
+
+#if defined(__linux__)
+	inline int GetFutexOp(int Op, EScope Scope)
+	{
+		return Scope == EScope::Process ? (Op | FUTEX_PRIVATE_FLAG) : Op;
+	}
+
+	inline void FutexWait(std::atomic<uint32_t>& Word, uint32_t Expected, std::chrono::nanoseconds Timeout, EScope Scope)
+	{
+		timespec Relative;
+		Relative.tv_sec = time_t(Timeout.count() / 1000000000);
+		Relative.tv_nsec = long(Timeout.count() % 1000000000);
+
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(&Word), GetFutexOp(FUTEX_WAIT, Scope), Expected, &Relative, nullptr, 0);
+	}
+
+	inline void FutexWakeAll(std::atomic<uint32_t>& Word, EScope Scope)
+	{
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(&Word), GetFutexOp(FUTEX_WAKE, Scope), INT_MAX, nullptr, nullptr, 0);
+	}
+#endif
+
+	inline void Signal(FLayout& Layout, uint64_t FrameNumber, EScope Scope)
+	{
+		// Odd while writing, waiters that read the frame number meanwhile throw it away
+		Layout.Sequence.store(Layout.Sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		Layout.FrameNumber.store(FrameNumber, std::memory_order_relaxed);
+		Layout.Sequence.fetch_add(1, std::memory_order_seq_cst);
+
+#if defined(__linux__)
+		// Sequentially consistent with the waiter's NumWaiters increment and Sequence check, so either the
+		// waiter sees the new sequence or this sees the waiter
+		if (Layout.NumWaiters.load(std::memory_order_seq_cst) != 0)
+		{
+			FutexWakeAll(Layout.Sequence, Scope);
+		}
+#endif
+	}
+
+	// Sequence to pass to the first Wait, only signals after this call count. A signal in progress counts
+	// as after it.
+	inline uint32_t GetSequence(const FLayout& Layout)
+	{
+		return Layout.Sequence.load(std::memory_order_acquire) & ~1u;
+	}
+
+	// Waits until the sequence differs from InOutSequence, which is then updated. False on timeout.
+	inline bool Wait(FLayout& Layout, uint32_t& InOutSequence, std::chrono::nanoseconds Timeout, EScope Scope, uint64_t* OutFrameNumber = nullptr)
+	{
+		using FClock = std::chrono::steady_clock;
+		const FClock::time_point Deadline = FClock::now() + Timeout;
+
+		for (;;)
+		{
+			const uint32_t Sequence = Layout.Sequence.load(std::memory_order_acquire);
+			const bool bSignalling = (Sequence & 1) != 0;
+
+			if (!bSignalling && Sequence != InOutSequence)
+			{
+				const uint64_t FrameNumber = Layout.FrameNumber.load(std::memory_order_relaxed);
+
+				// Another signal started since the load above, its frame number may be the one just read
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (Layout.Sequence.load(std::memory_order_relaxed) != Sequence)
+					continue;
+
+				InOutSequence = Sequence;
+				if (OutFrameNumber)
+				{
+					*OutFrameNumber = FrameNumber;
+				}
+				return true;
+			}
+
+			const FClock::duration Remaining = Deadline - FClock::now();
+			if (Remaining <= FClock::duration::zero())
+				return false;
+
+			// The sender is between its two bumps, done in a moment
+			if (bSignalling)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+#if defined(__linux__)
+			Layout.NumWaiters.fetch_add(1, std::memory_order_seq_cst);
+			if (Layout.Sequence.load(std::memory_order_seq_cst) == InOutSequence)
+			{
+				// Returns right away when the sequence changed since the load above
+				FutexWait(Layout.Sequence, InOutSequence, std::chrono::duration_cast<std::chrono::nanoseconds>(Remaining), Scope);
+			}
+			Layout.NumWaiters.fetch_sub(1, std::memory_order_seq_cst);
+#else
+			(void)Scope;
+			std::this_thread::sleep_for(std::min<FClock::duration>(Remaining, std::chrono::microseconds(250)));
+#endif
+		}
+	}
+}
@@ -1,60 +1,122 @@
 ﻿#include "SpoutFrameSyncHelper.h"
 #include "Misc/ScopeLock.h"
 #include "HAL/PlatformTime.h"
+#include "HAL/PlatformProcess.h"
 
-FSpoutFrameSyncHelper::FSpoutFrameSyncHelper()
-    : bFrameCountEnabled(true)
-    , TargetFPS(60)
-    , LastFrameTime(0.0)
-    , FrameInterval(1.0/60.0)
-    , FrameCount(0)
+FSpoutFrameSyncChannel::FSpoutFrameSyncChannel(const FString& SenderName)
 {
+    // Either side may come first, the layout is valid zero-filled. The name stays for the next sender.
+    const std::string MemoryName = std::string(TCHAR_TO_ANSI(*SenderName)) + "_SpoutSync";
+    if (Memory.Create(MemoryName, sizeof(SpoutFrameSignal::FLayout), true))
+    {
+        Layout = static_cast<SpoutFrameSignal::FLayout*>(Memory.GetData());
+        LastSequence = SpoutFrameSignal::GetSequence(*Layout);
+    }
+
+#if PLATFORM_WINDOWS
+    // Format event name to ensure uniqueness, opens the event when another process created it
+    const FString EventName = FString::Printf(TEXT("Spout-Sync-%s"), *SenderName);
+    Event = CreateEventA(NULL, false, false, TCHAR_TO_ANSI(*EventName));
+    if (Event == INVALID_HANDLE_VALUE)
+    {
+        Event = NULL;
+    }
+#endif
 }
 
-FSpoutFrameSyncHelper::~FSpoutFrameSyncHelper()
+FSpoutFrameSyncChannel::~FSpoutFrameSyncChannel()
 {
-    FScopeLock Lock(&SyncEventsLock);
-    // Clean up all sync events
-    for (TPair<FString, HANDLE>& Event : SyncEvents)
+#if PLATFORM_WINDOWS
+    if (Event)
     {
-        if (Event.Value != NULL && Event.Value != INVALID_HANDLE_VALUE)
-        {
-            CloseHandle(Event.Value);
-            Event.Value = NULL;
-        }
+        CloseHandle(Event);
+        Event = NULL;
     }
-    SyncEvents.Empty();
+#endif
 }
 
-void FSpoutFrameSyncHelper::HoldFps(int fps)
+void FSpoutFrameSyncChannel::Signal(uint64 FrameNumber)
 {
-    if (!bFrameCountEnabled || fps <= 0)
-        return;
-    
-    TargetFPS = fps;
-    FrameInterval = 1.0 / static_cast<double>(fps);
-    
-    // Calculate wait time to achieve target FPS
-    double CurrentTime = FPlatformTime::Seconds();
-    double ElapsedTime = CurrentTime - LastFrameTime;
-    
-    // Only wait if we're ahead of schedule
-    if (ElapsedTime < FrameInterval)
+    if (Layout)
     {
-        double WaitTime = FrameInterval - ElapsedTime;
-        
-        // Convert to milliseconds for FPlatformProcess::Sleep
-        const float SleepTime = static_cast<float>(WaitTime * 1000.0);
-        
-        if (SleepTime > 1.0f)  // Only sleep for meaningful durations
+        SpoutFrameSignal::Signal(*Layout, FrameNumber, SpoutFrameSignal::EScope::Shared);
+    }
+
+#if PLATFORM_WINDOWS
+    if (Event)
+    {
+        SetEvent(Event);
+    }
+#endif
+}
+
+bool FSpoutFrameSyncChannel::Wait(uint32 TimeoutMs, uint64* OutFrameNumber)
+{
+#if PLATFORM_WINDOWS
+    // Other Spout applications only set the event, the frame number is the latest one this plugin signalled
+    if (!Event || WaitForSingleObject(Event, TimeoutMs) != WAIT_OBJECT_0)
+        return false;
+
+    if (Layout)
+    {
+        LastSequence = SpoutFrameSignal::GetSequence(*Layout);
+        if (OutFrameNumber)
         {
-            FPlatformProcess::Sleep(SleepTime / 1000.0f); // Sleep takes seconds
+            *OutFrameNumber = Layout->FrameNumber.load(std::memory_order_relaxed);
         }
     }
+    return true;
+#else
+    if (!Layout)
+        return false;
+
+    return SpoutFrameSignal::Wait(*Layout, LastSequence, std::chrono::milliseconds(TimeoutMs), SpoutFrameSignal::EScope::Shared, OutFrameNumber);
+#endif
+}
+
+bool FSpoutFrameSyncChannel::Observe(uint32& InOutSequence, uint32 TimeoutMs, uint64* OutFrameNumber)
+{
+    if (!Layout)
+    {
+        FPlatformProcess::Sleep(TimeoutMs / 1000.0f);
+        return false;
+    }
+
+    // The Windows event is auto-reset, waiting on it here would take frames from the receivers
+    return SpoutFrameSignal::Wait(*Layout, InOutSequence, std::chrono::milliseconds(TimeoutMs), SpoutFrameSignal::EScope::Shared, OutFrameNumber);
+}
+
+uint32 FSpoutFrameSyncChannel::GetSequence() const
+{
+    return Layout ? SpoutFrameSignal::GetSequence(*Layout) : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+FSpoutFrameSyncHelper::FSpoutFrameSyncHelper()
+    : bFrameCountEnabled(true)
+{
+}
+
+FSpoutFrameSyncHelper::~FSpoutFrameSyncHelper()
+{
+    FScopeLock Lock(&SyncChannelsLock);
+    SyncChannels.Empty();
+}
+
+void FSpoutFrameSyncHelper::HoldFps(int fps)
+{
+    HoldFps(FFrameRate(fps, 1));
+}
+
+void FSpoutFrameSyncHelper::HoldFps(const FFrameRate& FrameRate)
+{
+    if (!bFrameCountEnabled || FrameRate.Numerator <= 0 || FrameRate.Denominator <= 0)
+        return;
     
-    // Update last frame time after any waiting
-    LastFrameTime = FPlatformTime::Seconds();
-    FrameCount++;
+    // Waits for the next absolute deadline, so time spent between calls does not add up
+    Pacer.SetFrameRate(FrameRate.Numerator, FrameRate.Denominator);
+    Pacer.WaitForNextFrame();
 }
 
 void FSpoutFrameSyncHelper::DisableFrameCount()
@@ -67,87 +129,44 @@ bool FSpoutFrameSyncHelper::IsFrameCountEnabled() const
     return bFrameCountEnabled;
 }
 
-FString FSpoutFrameSyncHelper::GetEventName(const FString& SenderName)
-{
-    // Format event name to ensure uniqueness
-    return FString::Printf(TEXT("Spout-Sync-%s"), *SenderName);
-}
-
-void FSpoutFrameSyncHelper::SetFrameSync(const FString& SenderName)
+void FSpoutFrameSyncHelper::SetFrameSync(const FString& SenderName, uint64 FrameNumber)
 {
     if (SenderName.IsEmpty())
         return;
     
-    FScopeLock Lock(&SyncEventsLock);
-    
-    const FString EventName = GetEventName(SenderName);
-    HANDLE SyncEvent = NULL;
+    GetFrameSyncChannel(SenderName)->Signal(FrameNumber);
+}
+
+TSharedPtr<FSpoutFrameSyncChannel, ESPMode::ThreadSafe> FSpoutFrameSyncHelper::GetFrameSyncChannel(const FString& SenderName)
+{
+    FScopeLock Lock(&SyncChannelsLock);
     
-    // Check if we already have this event
-    if (SyncEvents.Contains(SenderName))
+    // Only named on first use, waits run every frame
+    TSharedPtr<FSpoutFrameSyncChannel, ESPMode::ThreadSafe>& Channel = SyncChannels.FindOrAdd(SenderName);
+    if (!Channel)
     {
-        SyncEvent = SyncEvents[SenderName];
-    }
-    else
-    {
-        // Create a new sync event
-        SyncEvent = CreateEventA(NULL, false, false, TCHAR_TO_ANSI(*EventName));
-        if (SyncEvent != NULL && SyncEvent != INVALID_HANDLE_VALUE)
-        {
-            SyncEvents.Add(SenderName, SyncEvent);
-        }
+        Channel = MakeShared<FSpoutFrameSyncChannel, ESPMode::ThreadSafe>(SenderName);
     }
     
-    // Signal the event
-    if (SyncEvent != NULL && SyncEvent != INVALID_HANDLE_VALUE)
-    {
-        SetEvent(SyncEvent);
-    }
+    return Channel;
 }
 
-bool FSpoutFrameSyncHelper::WaitFrameSync(const FString& SenderName, DWORD dwTimeout)
+#if PLATFORM_WINDOWS
+HANDLE FSpoutFrameSyncHelper::GetFrameSyncEvent(const FString& SenderName)
 {
     if (SenderName.IsEmpty())
-        return false;
-    
-    HANDLE SyncEvent = NULL;
+        return NULL;
     
-    {
-        FScopeLock Lock(&SyncEventsLock);
-        const FString EventName = GetEventName(SenderName);
-        
-        // Check if we have this event
-        if (SyncEvents.Contains(SenderName))
-        {
-            SyncEvent = SyncEvents[SenderName];
-        }
-        else
-        {
-            // Try to open existing event
-            SyncEvent = OpenEventA(SYNCHRONIZE, false, TCHAR_TO_ANSI(*EventName));
-            if (SyncEvent != NULL && SyncEvent != INVALID_HANDLE_VALUE)
-            {
-                SyncEvents.Add(SenderName, SyncEvent);
-            }
-            else
-            {
-                // If event doesn't exist yet, create it
-                SyncEvent = CreateEventA(NULL, false, false, TCHAR_TO_ANSI(*EventName));
-                if (SyncEvent != NULL && SyncEvent != INVALID_HANDLE_VALUE)
-                {
-                    SyncEvents.Add(SenderName, SyncEvent);
-                }
-                else
-                {
-                    return false;
-                }
-            }
-        }
-    }
+    return GetFrameSyncChannel(SenderName)->GetEvent();
+}
+#endif
+
+bool FSpoutFrameSyncHelper::WaitFrameSync(const FString& SenderName, uint32 TimeoutMs, uint64* OutFrameNumber)
+{
+    if (SenderName.IsEmpty())
+        return false;
     
-    // Wait for the event
-    DWORD WaitResult = WaitForSingleObject(SyncEvent, dwTimeout);
-    return (WaitResult == WAIT_OBJECT_0);
+    return GetFrameSyncChannel(SenderName)->Wait(TimeoutMs, OutFrameNumber);
 }
 
 void FSpoutFrameSyncHelper::ClearFrameSync(const FString& SenderName)
@@ -155,15 +174,6 @@ void FSpoutFrameSyncHelper::ClearFrameSync(const FString& SenderName)
     if (SenderName.IsEmpty())
         return;
     
-    FScopeLock Lock(&SyncEventsLock);
-    
-    if (SyncEvents.Contains(SenderName))
-    {
-        HANDLE SyncEvent = SyncEvents[SenderName];
-        if (SyncEvent != NULL && SyncEvent != INVALID_HANDLE_VALUE)
-        {
-            CloseHandle(SyncEvent);
-        }
-        SyncEvents.Remove(SenderName);
-    }
+    FScopeLock Lock(&SyncChannelsLock);
+    SyncChannels.Remove(SenderName);
 }
\ No newline at end of file
@@ -3,9 +3,59 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Misc/FrameRate.h"
+
+#if PLATFORM_WINDOWS
 #include "Windows/AllowWindowsPlatformTypes.h" 
 #include <Windows.h>
 #include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+#include "SpoutFramePacer.h"
+#include "SpoutFrameSignal.h"
+#include "SpoutSharedMemory.h"
+
+/**
+ * Sync channel of one sender: a SpoutFrameSignal in the shared memory "<sender>_SpoutSync", carrying the
+ * frame number, and on Windows the named event other Spout applications wait on. Waits block on the
+ * event on Windows and on the signal's futex on Linux.
+ *
+ * Referenced by whoever signals or waits, so a sender can signal from its send thread after the helper
+ * let go of the channel.
+ */
+class FSpoutFrameSyncChannel
+{
+public:
+    explicit FSpoutFrameSyncChannel(const FString& SenderName);
+    ~FSpoutFrameSyncChannel();
+
+    void Signal(uint64 FrameNumber);
+
+    // Waits for a signal after the previous Wait, OutFrameNumber is the frame it was given
+    bool Wait(uint32 TimeoutMs, uint64* OutFrameNumber = nullptr);
+
+    // Waits for a signal after InOutSequence on the shared signal only, leaving the event to the waiters
+    // above. Sees the senders of this plugin, not other Spout applications, which only set the event.
+    bool Observe(uint32& InOutSequence, uint32 TimeoutMs, uint64* OutFrameNumber = nullptr);
+
+    // Sequence to pass to the first Observe
+    uint32 GetSequence() const;
+
+#if PLATFORM_WINDOWS
+    HANDLE GetEvent() const { return Event; }
+#endif
+
+private:
+    FSpoutSharedMemory Memory;
+    SpoutFrameSignal::FLayout* Layout = nullptr;
+
+    // Signal sequence the last Wait returned on
+    uint32 LastSequence = 0;
+
+#if PLATFORM_WINDOWS
+    HANDLE Event = nullptr;
+#endif
+};
 
 /**
  * Helper class to manage Spout frame synchronization between senders and receivers
@@ -16,16 +66,28 @@ public:
     FSpoutFrameSyncHelper();
     ~FSpoutFrameSyncHelper();
 
-    // Frame rate control
+    // Frame rate control, blocks until the next frame of the given rate is due
     void HoldFps(int fps);
+    void HoldFps(const FFrameRate& FrameRate);
+    
+    // Jitter of the frames HoldFps released
+    const FSpoutFramePacer::FJitterStats& GetJitterStats() const { return Pacer.GetJitterStats(); }
     
     // Frame counting management
     void DisableFrameCount();
     bool IsFrameCountEnabled() const;
     
     // Sync events
-    void SetFrameSync(const FString& SenderName);
-    bool WaitFrameSync(const FString& SenderName, DWORD dwTimeout);
+    void SetFrameSync(const FString& SenderName, uint64 FrameNumber = 0);
+    bool WaitFrameSync(const FString& SenderName, uint32 TimeoutMs, uint64* OutFrameNumber = nullptr);
+    
+    // Sync channel of a sender, created on first use and held by the helper until ClearFrameSync
+    TSharedPtr<FSpoutFrameSyncChannel, ESPMode::ThreadSafe> GetFrameSyncChannel(const FString& SenderName);
+    
+#if PLATFORM_WINDOWS
+    // Named event of a sender's channel, for waiting on several senders at once
+    HANDLE GetFrameSyncEvent(const FString& SenderName);
+#endif
     
     // Clear any existing sync events
     void ClearFrameSync(const FString& SenderName);
@@ -33,17 +95,9 @@ public:
 private:
     // FPS control
     bool bFrameCountEnabled;
-    int TargetFPS;
-    double LastFrameTime;
-    double FrameInterval;
-    
-    // Time tracking
-    uint64 FrameCount;
-    
-    // Event handling
-    TMap<FString, HANDLE> SyncEvents;
-    FCriticalSection SyncEventsLock;
+    FSpoutFramePacer Pacer;
     
-    // Helper methods
-    FString GetEventName(const FString& SenderName);
+    // Channel handling
+    TMap<FString, TSharedPtr<FSpoutFrameSyncChannel, ESPMode::ThreadSafe>> SyncChannels;
+    FCriticalSection SyncChannelsLock;
 };
\ No newline at end of file
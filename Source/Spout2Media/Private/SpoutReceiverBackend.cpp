@@ -0,0 +1,321 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SpoutReceiverBackend.h"
+
+#include "HAL/IConsoleManager.h"
+#include "ID3D12DynamicRHI.h"
+#include "RHICommandList.h"
+
+#include "Spout2MediaTextureSample.h"
+#include "SpoutD3D11On12Device.h"
+
+static TAutoConsoleVariable<int32> CVarSpoutReceiverBackend(
+	TEXT("Spout2Media.ReceiverBackend"),
+	0,
+	TEXT("Backend used to import Spout textures on the receive side. Applies to receivers created afterwards.\n")
+	TEXT(" 0: D3D11 on the D3D11 RHI, D3D11On12 on the D3D12 RHI (default)\n")
+	TEXT(" 1: D3D11On12 on the D3D12 RHI\n")
+	TEXT(" 2: mock backend that opens and copies nothing\n")
+	TEXT(" 3: native D3D12 on the D3D12 RHI. Spout's legacy share handles are usually refused by it, receivers then fall back to D3D11On12."),
+	ECVF_Default);
+
+/////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	/** Shared texture opened on a D3D11 device, common to the D3D11 and D3D11On12 backends */
+	class FSpoutD3D11ReceiverBackendBase
+		: public ISpoutReceiverBackend
+	{
+	protected:
+		ID3D11Device* D3D11Device = nullptr;
+		ID3D11DeviceContext* DeviceContext = nullptr;
+
+		HANDLE SharedHandle = nullptr;
+		ID3D11Resource* SharedResource = nullptr;
+
+	public:
+		virtual bool OpenSharedTexture(HANDLE ShareHandle) override
+		{
+			if (SharedResource && SharedHandle == ShareHandle)
+				return true;
+
+			CloseSharedTexture();
+
+			if (D3D11Device->OpenSharedResource(ShareHandle, __uuidof(ID3D11Resource), (void**)(&SharedResource)) != S_OK)
+			{
+				SharedResource = nullptr;
+				return false;
+			}
+
+			SharedHandle = ShareHandle;
+			return true;
+		}
+
+		virtual void CloseSharedTexture() override
+		{
+			if (SharedResource)
+			{
+				SharedResource->Release();
+				SharedResource = nullptr;
+			}
+
+			SharedHandle = nullptr;
+		}
+
+		virtual bool IsSharedTextureOpen() const override
+		{
+			return SharedResource != nullptr;
+		}
+	};
+
+	class FSpoutD3D11ReceiverBackend
+		: public FSpoutD3D11ReceiverBackendBase
+	{
+	public:
+		FSpoutD3D11ReceiverBackend()
+		{
+			// The device belongs to the RHI, only the immediate context reference is ours
+			D3D11Device = static_cast<ID3D11Device*>(GDynamicRHI->RHIGetNativeDevice());
+			D3D11Device->GetImmediateContext(&DeviceContext);
+		}
+
+		virtual ~FSpoutD3D11ReceiverBackend() override
+		{
+			CloseSharedTexture();
+
+			if (DeviceContext)
+			{
+				DeviceContext->Release();
+				DeviceContext = nullptr;
+			}
+		}
+
+		virtual ESpoutReceiverBackend GetType() const override { return ESpoutReceiverBackend::D3D11; }
+
+		virtual bool CopyToSample(FRHICommandListImmediate& RHICmdList, FSpout2MediaTextureSample& Sample) override
+		{
+			if (!SharedResource || !Sample.GetTexture())
+				return false;
+
+			// The immediate context belongs to the RHI, so copy on the RHI thread in order with its own work.
+			// No Flush, the RHI submits it with the rest of the frame and the fence tells when it landed.
+			RHICmdList.EnqueueLambda([
+				DeviceContext = TRefCountPtr<ID3D11DeviceContext>(DeviceContext),
+				SrcResource = TRefCountPtr<ID3D11Resource>(SharedResource),
+				DestTexture = FTextureRHIRef(Sample.GetTexture())](FRHICommandListImmediate&)
+			{
+				DeviceContext->CopyResource(static_cast<ID3D11Resource*>(DestTexture->GetNativeResource()), SrcResource);
+			});
+
+			Sample.GetCopyFence().WriteRHI(RHICmdList);
+			return true;
+		}
+	};
+
+	class FSpoutD3D11On12ReceiverBackend
+		: public FSpoutD3D11ReceiverBackendBase
+	{
+		// Shared with every other receiver and sender, its context is not ordered with the RHI's queue
+		TSharedPtr<FSpoutD3D11On12Device, ESPMode::ThreadSafe> SharedDevice;
+
+	public:
+		FSpoutD3D11On12ReceiverBackend()
+			: SharedDevice(FSpoutD3D11On12Device::Get())
+		{
+			D3D11Device = SharedDevice->GetDevice();
+			DeviceContext = SharedDevice->GetContext();
+		}
+
+		virtual ~FSpoutD3D11On12ReceiverBackend() override
+		{
+			CloseSharedTexture();
+		}
+
+		virtual ESpoutReceiverBackend GetType() const override { return ESpoutReceiverBackend::D3D11On12; }
+
+		virtual bool CopyToSample(FRHICommandListImmediate& RHICmdList, FSpout2MediaTextureSample& Sample) override
+		{
+			ID3D11On12Device* D3D11on12Device = SharedDevice->GetOn12Device();
+			ID3D11Resource* WrappedDX11Resource = Sample.GetWrappedResource(D3D11on12Device);
+			if (!SharedResource || !WrappedDX11Resource)
+				return false;
+
+			FScopeLock Lock(&SharedDevice->GetContextLock());
+
+			D3D11on12Device->AcquireWrappedResources(&WrappedDX11Resource, 1);
+			DeviceContext->CopyResource(WrappedDX11Resource, SharedResource);
+			D3D11on12Device->ReleaseWrappedResources(&WrappedDX11Resource, 1);
+			SharedDevice->GetFenceSource().Signal(Sample.GetCopyFence());
+
+			// Submitted with the other streams' copies at the end of the frame
+			SharedDevice->RequestFlush();
+			return true;
+		}
+	};
+
+	class FSpoutD3D12ReceiverBackend
+		: public ISpoutReceiverBackend
+	{
+		ID3D12Device* D3D12Device = nullptr;
+		EPixelFormat PixelFormat = PF_Unknown;
+
+		HANDLE SharedHandle = nullptr;
+
+		// RHI texture around the opened resource, its deferred deletion keeps the resource alive for in-flight copies
+		FTextureRHIRef SharedTexture;
+
+	public:
+		FSpoutD3D12ReceiverBackend(EPixelFormat InPixelFormat)
+			: D3D12Device(static_cast<ID3D12Device*>(GDynamicRHI->RHIGetNativeDevice()))
+			, PixelFormat(InPixelFormat)
+		{
+		}
+
+		virtual ~FSpoutD3D12ReceiverBackend() override
+		{
+			CloseSharedTexture();
+		}
+
+		virtual ESpoutReceiverBackend GetType() const override { return ESpoutReceiverBackend::D3D12; }
+
+		virtual bool OpenSharedTexture(HANDLE ShareHandle) override
+		{
+			if (SharedTexture && SharedHandle == ShareHandle)
+				return true;
+
+			CloseSharedTexture();
+
+			TRefCountPtr<ID3D12Resource> Resource;
+			if (D3D12Device->OpenSharedHandle(ShareHandle, IID_PPV_ARGS(Resource.GetInitReference())) != S_OK)
+				return false;
+
+			SharedTexture = GetID3D12DynamicRHI()->RHICreateTexture2DFromResource(
+				PixelFormat, ETextureCreateFlags::Shared, FClearValueBinding::None, Resource);
+			if (!SharedTexture)
+				return false;
+
+			SharedHandle = ShareHandle;
+			return true;
+		}
+
+		virtual void CloseSharedTexture() override
+		{
+			SharedTexture.SafeRelease();
+			SharedHandle = nullptr;
+		}
+
+		virtual bool IsSharedTextureOpen() const override
+		{
+			return SharedTexture.IsValid();
+		}
+
+		virtual bool CopyToSample(FRHICommandListImmediate& RHICmdList, FSpout2MediaTextureSample& Sample) override
+		{
+			FRHITexture* DestTexture = Sample.GetTexture();
+			if (!SharedTexture || !DestTexture)
+				return false;
+
+			RHICmdList.Transition({
+				FRHITransitionInfo(SharedTexture, ERHIAccess::Unknown, ERHIAccess::CopySrc),
+				FRHITransitionInfo(DestTexture, ERHIAccess::Unknown, ERHIAccess::CopyDest)
+			});
+
+			RHICmdList.CopyTexture(SharedTexture, DestTexture, FRHICopyTextureInfo());
+
+			RHICmdList.Transition({
+				FRHITransitionInfo(SharedTexture, ERHIAccess::CopySrc, ERHIAccess::SRVMask),
+				FRHITransitionInfo(DestTexture, ERHIAccess::CopyDest, ERHIAccess::SRVMask)
+			});
+
+			Sample.GetCopyFence().WriteRHI(RHICmdList);
+			return true;
+		}
+	};
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool FSpoutMockReceiverBackend::OpenSharedTexture(HANDLE ShareHandle)
+{
+	if (OpenHandle == ShareHandle)
+		return true;
+
+	CloseSharedTexture();
+
+	OpenHandle = ShareHandle;
+	NumOpens++;
+	return OpenHandle != nullptr;
+}
+
+void FSpoutMockReceiverBackend::CloseSharedTexture()
+{
+	if (OpenHandle)
+	{
+		OpenHandle = nullptr;
+		NumCloses++;
+	}
+}
+
+bool FSpoutMockReceiverBackend::CopyToSample(FRHICommandListImmediate& RHICmdList, FSpout2MediaTextureSample& Sample)
+{
+	if (!OpenHandle)
+		return false;
+
+	NumCopies++;
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool FSpoutTransportReceiverBackend::CopyToSample(FRHICommandListImmediate& RHICmdList, FSpout2MediaTextureSample& Sample)
+{
+	FRHITexture* DestTexture = Sample.GetTexture();
+	if (!Data || !DestTexture)
+		return false;
+
+	const FIntPoint Size = Sample.GetDim();
+	RHICmdList.UpdateTexture2D(DestTexture, 0, FUpdateTextureRegion2D(0, 0, 0, 0, Size.X, Size.Y), Stride, Data);
+
+	Sample.GetCopyFence().WriteRHI(RHICmdList);
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+ESpoutReceiverBackend SpoutReceiverBackend::Select(ERHIInterfaceType RHIType, int32 Preference)
+{
+	if (Preference == 2)
+		return ESpoutReceiverBackend::Mock;
+
+	if (RHIType == ERHIInterfaceType::D3D11)
+		return ESpoutReceiverBackend::D3D11;
+
+	// Spout shares textures through legacy handles, which OpenSharedHandle only accepts from some drivers
+	if (RHIType == ERHIInterfaceType::D3D12)
+		return Preference == 3 ? ESpoutReceiverBackend::D3D12 : ESpoutReceiverBackend::D3D11On12;
+
+	return ESpoutReceiverBackend::None;
+}
+
+ESpoutReceiverBackend SpoutReceiverBackend::SelectForCurrentRHI()
+{
+	return Select(RHIGetInterfaceType(), CVarSpoutReceiverBackend.GetValueOnAnyThread());
+}
+
+TUniquePtr<ISpoutReceiverBackend> SpoutReceiverBackend::Create(ESpoutReceiverBackend Type, EPixelFormat PixelFormat)
+{
+	switch (Type)
+	{
+	case ESpoutReceiverBackend::D3D11:
+		return MakeUnique<FSpoutD3D11ReceiverBackend>();
+	case ESpoutReceiverBackend::D3D11On12:
+		return MakeUnique<FSpoutD3D11On12ReceiverBackend>();
+	case ESpoutReceiverBackend::D3D12:
+		return MakeUnique<FSpoutD3D12ReceiverBackend>(PixelFormat);
+	case ESpoutReceiverBackend::Mock:
+		return MakeUnique<FSpoutMockReceiverBackend>();
+	default:
+		return nullptr;
+	}
+}
@@ -0,0 +1,107 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI.h"
+
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <d3d11on12.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+
+class FSpout2MediaTextureSample;
+
+enum class ESpoutReceiverBackend : uint8
+{
+	None,
+	// D3D11 RHI, copies on the RHI's immediate context
+	D3D11,
+	// D3D12 RHI, copies through a D3D11On12 device
+	D3D11On12,
+	// D3D12 RHI, opens the share handle on the D3D12 device and copies on the RHI command list.
+	// Only used when Spout2Media.ReceiverBackend asks for it, see FSpoutReceiverContext for the fallback.
+	D3D12,
+	// Opens and copies nothing, for exercising the receive logic without a GPU
+	Mock,
+	// Uploads CPU frames of a SpoutTransport, created by the receiver context for transport senders
+	Transport,
+};
+
+/**
+ * Imports a Spout sender's shared texture and copies it into receive samples.
+ * Each receiver context owns one backend; Open, Close and Copy are called on the render thread.
+ */
+class ISpoutReceiverBackend
+{
+public:
+	virtual ~ISpoutReceiverBackend() {}
+
+	virtual ESpoutReceiverBackend GetType() const = 0;
+
+	// Opens the sender texture behind ShareHandle. Reopens only when the handle changed.
+	virtual bool OpenSharedTexture(HANDLE ShareHandle) = 0;
+	virtual void CloseSharedTexture() = 0;
+	virtual bool IsSharedTextureOpen() const = 0;
+
+	// Records the copy of the open shared texture into the sample's texture
+	virtual bool CopyToSample(FRHICommandListImmediate& RHICmdList, FSpout2MediaTextureSample& Sample) = 0;
+};
+
+/**
+ * Backend that only tracks its lifecycle, used when Spout2Media.ReceiverBackend selects it.
+ */
+class FSpoutMockReceiverBackend
+	: public ISpoutReceiverBackend
+{
+public:
+	HANDLE OpenHandle = nullptr;
+
+	int32 NumOpens = 0;
+	int32 NumCloses = 0;
+	int32 NumCopies = 0;
+
+	//~ ISpoutReceiverBackend interface
+	virtual ESpoutReceiverBackend GetType() const override { return ESpoutReceiverBackend::Mock; }
+	virtual bool OpenSharedTexture(HANDLE ShareHandle) override;
+	virtual void CloseSharedTexture() override;
+	virtual bool IsSharedTextureOpen() const override { return OpenHandle != nullptr; }
+	virtual bool CopyToSample(FRHICommandListImmediate& RHICmdList, FSpout2MediaTextureSample& Sample) override;
+};
+
+/**
+ * Uploads a frame the receiver context acquired from a SpoutTransport. There is no shared texture,
+ * the context points the backend at the frame with SetFrame before each copy.
+ */
+class FSpoutTransportReceiverBackend
+	: public ISpoutReceiverBackend
+{
+public:
+	// Data stays valid until the copy was recorded, the upload takes its own copy of it
+	void SetFrame(const uint8* InData, uint32 InStride)
+	{
+		Data = InData;
+		Stride = InStride;
+	}
+
+	//~ ISpoutReceiverBackend interface
+	virtual ESpoutReceiverBackend GetType() const override { return ESpoutReceiverBackend::Transport; }
+	virtual bool OpenSharedTexture(HANDLE ShareHandle) override { return false; }
+	virtual void CloseSharedTexture() override { Data = nullptr; }
+	virtual bool IsSharedTextureOpen() const override { return Data != nullptr; }
+	virtual bool CopyToSample(FRHICommandListImmediate& RHICmdList, FSpout2MediaTextureSample& Sample) override;
+
+private:
+	const uint8* Data = nullptr;
+	uint32 Stride = 0;
+};
+
+namespace SpoutReceiverBackend
+{
+	// Picks the backend for an RHI, Preference is the value of Spout2Media.ReceiverBackend
+	ESpoutReceiverBackend Select(ERHIInterfaceType RHIType, int32 Preference);
+
+	// Backend selected for the running RHI and the current console variable value
+	ESpoutReceiverBackend SelectForCurrentRHI();
+
+	TUniquePtr<ISpoutReceiverBackend> Create(ESpoutReceiverBackend Type, EPixelFormat PixelFormat);
+}
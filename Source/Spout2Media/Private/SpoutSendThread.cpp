@@ -0,0 +1,131 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SpoutSendThread.h"
+
+#include "HAL/Event.h"
+#include "HAL/RunnableThread.h"
+
+namespace
+{
+	FCriticalSection SendThreadLock;
+	TUniquePtr<FSpoutSendThread> SendThread;
+
+	// Frames of all senders, several frames in flight per sender
+	constexpr uint32 SendQueueCapacity = 64;
+}
+
+FSpoutSendThread& FSpoutSendThread::Get()
+{
+	FScopeLock Lock(&SendThreadLock);
+
+	if (!SendThread)
+	{
+		SendThread = MakeUnique<FSpoutSendThread>();
+	}
+
+	return *SendThread;
+}
+
+void FSpoutSendThread::Shutdown()
+{
+	FScopeLock Lock(&SendThreadLock);
+	SendThread.Reset();
+}
+
+FSpoutSendThread::FSpoutSendThread()
+	: Frames(SendQueueCapacity + 1)
+	, WorkEvent(FPlatformProcess::GetSynchEventFromPool(false))
+	, bStopping(false)
+{
+	Thread = FRunnableThread::Create(this, TEXT("SpoutSendThread"), 0, TPri_AboveNormal);
+}
+
+FSpoutSendThread::~FSpoutSendThread()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	// Drops the references to senders whose frames never completed
+	FFrame Frame;
+	while (Frames.Dequeue(Frame))
+	{
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	WorkEvent = nullptr;
+}
+
+bool FSpoutSendThread::Enqueue(const TSharedPtr<ISpoutSendTarget, ESPMode::ThreadSafe>& Target, int32 Slot)
+{
+	FFrame Frame;
+	Frame.Target = Target;
+	Frame.Slot = Slot;
+
+	if (!Frames.Enqueue(MoveTemp(Frame)))
+		return false;
+
+	WorkEvent->Trigger();
+	return true;
+}
+
+uint32 FSpoutSendThread::Run()
+{
+	while (!bStopping)
+	{
+		FFrame* Frame = Frames.Peek();
+		if (!Frame)
+		{
+			WorkEvent->Wait();
+			continue;
+		}
+
+		if (ProcessFrame(*Frame))
+		{
+			Frames.Dequeue();
+			bSubmitted = false;
+		}
+		else
+		{
+			// The GPU has not reached the frame yet, check again shortly
+			WorkEvent->Wait(1);
+		}
+	}
+
+	return 0;
+}
+
+void FSpoutSendThread::Stop()
+{
+	bStopping = true;
+	WorkEvent->Trigger();
+}
+
+bool FSpoutSendThread::ProcessFrame(FFrame& Frame)
+{
+	ISpoutSendTarget& Target = *Frame.Target;
+
+	if (!bSubmitted)
+	{
+		if (!Target.IsRenderComplete_SendThread(Frame.Slot))
+			return false;
+
+		// Receivers would be told about a frame that never reached the shared texture
+		if (!Target.Submit_SendThread(Frame.Slot))
+		{
+			Target.Drop_SendThread(Frame.Slot);
+			return true;
+		}
+
+		bSubmitted = true;
+	}
+
+	if (!Target.WaitForSubmit_SendThread(Frame.Slot, 1))
+		return false;
+
+	Target.Publish_SendThread(Frame.Slot);
+	return true;
+}
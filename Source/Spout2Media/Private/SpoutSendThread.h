@@ -0,0 +1,77 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/CircularQueue.h"
+#include "HAL/Runnable.h"
+
+class FEvent;
+class FRunnableThread;
+
+/**
+ * Sender side of the send thread. A sender hands off frames from the render thread and does the
+ * D3D11 submission and the Spout metadata update for them on the send thread.
+ */
+class ISpoutSendTarget
+{
+public:
+	virtual ~ISpoutSendTarget() {}
+
+	// Whether the GPU finished what the render thread recorded for the frame in Slot
+	virtual bool IsRenderComplete_SendThread(int32 Slot) const = 0;
+
+	// Submits the D3D11 work of the frame in Slot, if it has any. False when the frame could not be
+	// copied, it is then dropped instead of published.
+	virtual bool Submit_SendThread(int32 Slot) = 0;
+
+	// Whether the work Submit_SendThread submitted completed, may block up to TimeoutMs
+	virtual bool WaitForSubmit_SendThread(int32 Slot, uint32 TimeoutMs) = 0;
+
+	// Tells receivers about the frame in Slot
+	virtual void Publish_SendThread(int32 Slot) = 0;
+
+	// Frees Slot without telling receivers about it, for frames Submit_SendThread could not copy
+	virtual void Drop_SendThread(int32 Slot) = 0;
+};
+
+/**
+ * Process-wide thread that finishes the frames of every Spout sender. The render thread only
+ * queues a reference to the sender and the slot of the frame, frames are completed in order.
+ */
+class FSpoutSendThread
+	: public FRunnable
+{
+public:
+	struct FFrame
+	{
+		TSharedPtr<ISpoutSendTarget, ESPMode::ThreadSafe> Target;
+		int32 Slot = 0;
+	};
+
+	// Started on first use, stopped by Shutdown
+	static FSpoutSendThread& Get();
+	static void Shutdown();
+
+	// Render thread side, the only producer. Returns false when the queue is full.
+	bool Enqueue(const TSharedPtr<ISpoutSendTarget, ESPMode::ThreadSafe>& Target, int32 Slot);
+
+	FSpoutSendThread();
+	virtual ~FSpoutSendThread() override;
+
+	//~ FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	// Finishes the oldest frame, returns false when it is still waiting on the GPU
+	bool ProcessFrame(FFrame& Frame);
+
+	TCircularQueue<FFrame> Frames;
+	FEvent* WorkEvent = nullptr;
+	FRunnableThread* Thread = nullptr;
+	TAtomic<bool> bStopping;
+
+	// Stage of the oldest frame, only used on the send thread
+	bool bSubmitted = false;
+};
@@ -0,0 +1,339 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Standard C++ only, so the directory builds and runs headless on any platform.
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "SpoutFrameSignal.h"
+
+/**
+ * Directory of the senders of this plugin, one open addressing hash table in shared memory that every
+ * process maps. Entries are keyed by the sender name without its "|FPS=" suffix, so receivers find a
+ * sender whatever frame rate it announces, and hold its full name and texture description.
+ *
+ * A sender claims a free entry once and owns it until it unregisters, only the owner writes it. Each entry
+ * is a sequence lock, odd while its owner writes, and has a SpoutFrameSignal whose sequence is the entry's
+ * generation: a receiver that resolved a sender checks the generation and reads the entry again only when
+ * it changed. The directory's own signal changes when a sender is added, removed or changes size or format.
+ *
+ * FLayout is valid zero-filled, so whichever process maps the directory first needs no initialization.
+ * Removed entries stay tombstones that later senders reuse, lookups only stop at never used ones.
+ *
+ * Spout2MediaStandaloneTests/SpoutSenderDirectoryBenchmark.cpp registers and looks up 1,000 senders across two processes.
+ */
+namespace SpoutSenderDirectory
+{
+	// Power of two, the table is probed linearly from the name's hash
+	static constexpr uint32_t NumSlots = 4096;
+
+	// Spout's limit, including the terminator
+	static constexpr uint32_t MaxNameLength = 256;
+
+	static constexpr uint32_t NoSlot = ~0u;
+
+	// Separates the name from the frame rate, see USpout2MediaOutput::GetModifiedSenderName
+	static constexpr const char* FrameRateSeparator = "|FPS=";
+
+	enum class EState : uint32_t
+	{
+		// Never used, ends a lookup
+		Empty,
+		// Being filled in by the sender that claimed it
+		Claimed,
+		Live,
+		// Unregistered, reused by the next sender that needs an entry
+		Removed,
+	};
+
+	// Description of a sender, as registered by it
+	struct FSenderInfo
+	{
+		// Full Spout name, with the frame rate suffix when the sender announces one
+		char Name[MaxNameLength] = {};
+
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+
+		// DXGI format and share handle of the shared texture, 0 for CPU frame transports
+		uint32_t Format = 0;
+		uint32_t ShareHandle = 0;
+
+		int32_t FrameRateNumerator = 0;
+		int32_t FrameRateDenominator = 0;
+
+		// ESpout2MediaTransport the sender publishes frames with
+		uint32_t Transport = 0;
+	};
+
+	struct alignas(64) FEntry
+	{
+		std::atomic<uint32_t> State;
+		std::atomic<uint32_t> Hash;
+
+		// Sequence lock around the fields below
+		std::atomic<uint32_t> Sequence;
+
+		std::atomic<uint32_t> Width;
+		std::atomic<uint32_t> Height;
+		std::atomic<uint32_t> Format;
+		std::atomic<uint32_t> ShareHandle;
+		std::atomic<int32_t> FrameRateNumerator;
+		std::atomic<int32_t> FrameRateDenominator;
+		std::atomic<uint32_t> Transport;
+		char Name[MaxNameLength];
+
+		// Signalled on every change of the entry
+		SpoutFrameSignal::FLayout Changed;
+	};
+
+	struct FLayout
+	{
+		// Signalled when a sender is added, removed or changes size or format, carries its slot
+		SpoutFrameSignal::FLayout Changed;
+		std::atomic<uint32_t> NumSenders;
+
+		FEntry Entries[NumSlots];
+	};
+
+	static_assert((NumSlots & (NumSlots - 1)) == 0, "Slots are picked by masking the hash");
+
+	// Length of Name without the frame rate suffix
+	inline size_t GetBaseNameLength(const char* Name)
+	{
+		const char* Separator = std::strstr(Name, FrameRateSeparator);
+		return Separator ? size_t(Separator - Name) : std::strlen(Name);
+	}
+
+	inline bool IsSameSender(const char* Name, const char* OtherName)
+	{
+		const size_t Length = GetBaseNameLength(Name);
+		return Length == GetBaseNameLength(OtherName) && std::memcmp(Name, OtherName, Length) == 0;
+	}
+
+	// FNV-1a of the name without the frame rate suffix
+	inline uint32_t HashName(const char* Name)
+	{
+		const size_t Length = GetBaseNameLength(Name);
+
+		uint32_t Hash = 2166136261u;
+		for (size_t Index = 0; Index < Length; Index++)
+		{
+			Hash = (Hash ^ uint8_t(Name[Index])) * 16777619u;
+		}
+		return Hash;
+	}
+
+	inline uint32_t GetDirectoryGeneration(const FLayout& Layout)
+	{
+		return SpoutFrameSignal::GetSequence(Layout.Changed);
+	}
+
+	// Changes with every update of the entry in Slot, including its removal and reuse
+	inline uint32_t GetGeneration(const FLayout& Layout, uint32_t Slot)
+	{
+		return SpoutFrameSignal::GetSequence(Layout.Entries[Slot].Changed);
+	}
+
+	// Copies the entry in Slot, false when it is not a live sender. OutGeneration is the generation the
+	// copy is at least as new as.
+	inline bool Read(const FLayout& Layout, uint32_t Slot, FSenderInfo& OutInfo, uint32_t* OutGeneration = nullptr, uint32_t MaxAttempts = 16)
+	{
+		const FEntry& Entry = Layout.Entries[Slot];
+
+		for (uint32_t Attempt = 0; Attempt < MaxAttempts; Attempt++)
+		{
+			const uint32_t Generation = GetGeneration(Layout, Slot);
+
+			const uint32_t SequenceBefore = Entry.Sequence.load(std::memory_order_acquire);
+			if (SequenceBefore & 1)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			if (Entry.State.load(std::memory_order_acquire) != uint32_t(EState::Live))
+				return false;
+
+			OutInfo.Width = Entry.Width.load(std::memory_order_relaxed);
+			OutInfo.Height = Entry.Height.load(std::memory_order_relaxed);
+			OutInfo.Format = Entry.Format.load(std::memory_order_relaxed);
+			OutInfo.ShareHandle = Entry.ShareHandle.load(std::memory_order_relaxed);
+			OutInfo.FrameRateNumerator = Entry.FrameRateNumerator.load(std::memory_order_relaxed);
+			OutInfo.FrameRateDenominator = Entry.FrameRateDenominator.load(std::memory_order_relaxed);
+			OutInfo.Transport = Entry.Transport.load(std::memory_order_relaxed);
+
+			// May race the owner, in which case the sequence check below throws the copy away
+			std::memcpy(OutInfo.Name, Entry.Name, MaxNameLength);
+			OutInfo.Name[MaxNameLength - 1] = 0;
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (Entry.Sequence.load(std::memory_order_relaxed) != SequenceBefore)
+				continue;
+
+			if (OutGeneration)
+			{
+				*OutGeneration = Generation;
+			}
+			return true;
+		}
+
+		return false;
+	}
+
+	// Slot of the sender going by Name, with or without frame rate suffix. NoSlot when it is not registered.
+	inline uint32_t Find(const FLayout& Layout, const char* Name, FSenderInfo& OutInfo, uint32_t* OutGeneration = nullptr)
+	{
+		const uint32_t Hash = HashName(Name);
+
+		for (uint32_t Probe = 0; Probe < NumSlots; Probe++)
+		{
+			const uint32_t Slot = (Hash + Probe) & (NumSlots - 1);
+			const FEntry& Entry = Layout.Entries[Slot];
+
+			const uint32_t State = Entry.State.load(std::memory_order_acquire);
+			if (State == uint32_t(EState::Empty))
+				return NoSlot;
+
+			if (State != uint32_t(EState::Live) || Entry.Hash.load(std::memory_order_relaxed) != Hash)
+				continue;
+
+			if (Read(Layout, Slot, OutInfo, OutGeneration) && IsSameSender(OutInfo.Name, Name))
+				return Slot;
+		}
+
+		return NoSlot;
+	}
+
+	// Calls Visit(Slot, Info) for each live sender
+	template<typename FVisitor>
+	void ForEachSender(const FLayout& Layout, FVisitor&& Visit)
+	{
+		FSenderInfo Info;
+		for (uint32_t Slot = 0; Slot < NumSlots; Slot++)
+		{
+			if (Layout.Entries[Slot].State.load(std::memory_order_acquire) == uint32_t(EState::Live)
+				&& Read(Layout, Slot, Info))
+			{
+				Visit(Slot, Info);
+			}
+		}
+	}
+
+	// Owner side, writes the entry it claimed
+	inline void Write(FLayout& Layout, uint32_t Slot, const FSenderInfo& Info)
+	{
+		FEntry& Entry = Layout.Entries[Slot];
+
+		const uint32_t OldWidth = Entry.Width.load(std::memory_order_relaxed);
+		const uint32_t OldHeight = Entry.Height.load(std::memory_order_relaxed);
+		const uint32_t OldFormat = Entry.Format.load(std::memory_order_relaxed);
+		const bool bLive = Entry.State.load(std::memory_order_relaxed) == uint32_t(EState::Live);
+
+		// Odd while writing, readers that saw the previous value throw their copy away
+		Entry.Sequence.store(Entry.Sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		Entry.Width.store(Info.Width, std::memory_order_relaxed);
+		Entry.Height.store(Info.Height, std::memory_order_relaxed);
+		Entry.Format.store(Info.Format, std::memory_order_relaxed);
+		Entry.ShareHandle.store(Info.ShareHandle, std::memory_order_relaxed);
+		Entry.FrameRateNumerator.store(Info.FrameRateNumerator, std::memory_order_relaxed);
+		Entry.FrameRateDenominator.store(Info.FrameRateDenominator, std::memory_order_relaxed);
+		Entry.Transport.store(Info.Transport, std::memory_order_relaxed);
+		std::memcpy(Entry.Name, Info.Name, MaxNameLength);
+		Entry.Name[MaxNameLength - 1] = 0;
+
+		Entry.Sequence.store(Entry.Sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+		// The entry is only published by Register, resizes of a live sender are directory changes too
+		SpoutFrameSignal::Signal(Entry.Changed, Slot, SpoutFrameSignal::EScope::Shared);
+		if (bLive && (OldWidth != Info.Width || OldHeight != Info.Height || OldFormat != Info.Format))
+		{
+			SpoutFrameSignal::Signal(Layout.Changed, Slot, SpoutFrameSignal::EScope::Shared);
+		}
+	}
+
+	// Adds the sender, or takes over the entry of a sender by the same name a process left behind.
+	// NoSlot when the directory is full.
+	inline uint32_t Register(FLayout& Layout, const FSenderInfo& Info)
+	{
+		const uint32_t Hash = HashName(Info.Name);
+
+		// Another sender may claim the same free entry, the loser looks again
+		for (uint32_t Attempt = 0; Attempt < NumSlots; Attempt++)
+		{
+			uint32_t FreeSlot = NoSlot;
+			uint32_t FreeState = 0;
+			FSenderInfo Existing;
+
+			for (uint32_t Probe = 0; Probe < NumSlots; Probe++)
+			{
+				const uint32_t Slot = (Hash + Probe) & (NumSlots - 1);
+				FEntry& Entry = Layout.Entries[Slot];
+				const uint32_t State = Entry.State.load(std::memory_order_acquire);
+
+				if (State == uint32_t(EState::Live)
+					&& Entry.Hash.load(std::memory_order_relaxed) == Hash
+					&& Read(Layout, Slot, Existing)
+					&& IsSameSender(Existing.Name, Info.Name))
+				{
+					Write(Layout, Slot, Info);
+					return Slot;
+				}
+
+				if (State == uint32_t(EState::Removed) && FreeSlot == NoSlot)
+				{
+					FreeSlot = Slot;
+					FreeState = State;
+				}
+
+				if (State == uint32_t(EState::Empty))
+				{
+					if (FreeSlot == NoSlot)
+					{
+						FreeSlot = Slot;
+						FreeState = State;
+					}
+					break;
+				}
+			}
+
+			if (FreeSlot == NoSlot)
+				return NoSlot;
+
+			FEntry& Entry = Layout.Entries[FreeSlot];
+			if (!Entry.State.compare_exchange_strong(FreeState, uint32_t(EState::Claimed)))
+				continue;
+
+			Entry.Hash.store(Hash, std::memory_order_relaxed);
+			Write(Layout, FreeSlot, Info);
+			Entry.State.store(uint32_t(EState::Live), std::memory_order_release);
+
+			Layout.NumSenders.fetch_add(1);
+			SpoutFrameSignal::Signal(Layout.Changed, FreeSlot, SpoutFrameSignal::EScope::Shared);
+			return FreeSlot;
+		}
+
+		return NoSlot;
+	}
+
+	// Owner side, removes the sender in Slot
+	inline void Unregister(FLayout& Layout, uint32_t Slot)
+	{
+		FEntry& Entry = Layout.Entries[Slot];
+
+		Entry.Sequence.store(Entry.Sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		Entry.State.store(uint32_t(EState::Removed), std::memory_order_relaxed);
+		Entry.Sequence.store(Entry.Sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+		Layout.NumSenders.fetch_sub(1);
+		SpoutFrameSignal::Signal(Entry.Changed, Slot, SpoutFrameSignal::EScope::Shared);
+		SpoutFrameSignal::Signal(Layout.Changed, Slot, SpoutFrameSignal::EScope::Shared);
+	}
+}
@@ -0,0 +1,110 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SpoutSenderDirectoryMapping.h"
+
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	FCriticalSection SharedDirectoryLock;
+	TWeakPtr<FSpoutSenderDirectoryMapping, ESPMode::ThreadSafe> SharedDirectory;
+}
+
+TSharedPtr<FSpoutSenderDirectoryMapping, ESPMode::ThreadSafe> FSpoutSenderDirectoryMapping::Get()
+{
+	FScopeLock Lock(&SharedDirectoryLock);
+
+	TSharedPtr<FSpoutSenderDirectoryMapping, ESPMode::ThreadSafe> Directory = SharedDirectory.Pin();
+	if (!Directory)
+	{
+		Directory = MakeShared<FSpoutSenderDirectoryMapping, ESPMode::ThreadSafe>();
+		SharedDirectory = Directory;
+	}
+
+	return Directory;
+}
+
+FSpoutSenderDirectoryMapping::FSpoutSenderDirectoryMapping()
+{
+	// Every process creates it, the layout is valid zero-filled and the name stays for the next one
+	if (Memory.Create("Spout2Media_SenderDirectory", sizeof(SpoutSenderDirectory::FLayout), true))
+	{
+		Layout = static_cast<SpoutSenderDirectory::FLayout*>(Memory.GetData());
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+FSpoutSenderDirectoryEntry::~FSpoutSenderDirectoryEntry()
+{
+	Unregister();
+}
+
+void FSpoutSenderDirectoryEntry::Register(const SpoutSenderDirectory::FSenderInfo& Info)
+{
+	if (IsRegistered())
+	{
+		SpoutSenderDirectory::Write(Directory->GetLayout(), Slot, Info);
+		return;
+	}
+
+	if (!Directory)
+	{
+		Directory = FSpoutSenderDirectoryMapping::Get();
+	}
+
+	// Receivers fall back to the Spout sender list when the directory is missing or full
+	if (Directory->IsOpen())
+	{
+		Slot = SpoutSenderDirectory::Register(Directory->GetLayout(), Info);
+	}
+}
+
+void FSpoutSenderDirectoryEntry::Unregister()
+{
+	if (IsRegistered())
+	{
+		SpoutSenderDirectory::Unregister(Directory->GetLayout(), Slot);
+		Slot = SpoutSenderDirectory::NoSlot;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+FSpoutSenderDirectoryLookup::FSpoutSenderDirectoryLookup(const char* InSenderName)
+	: Directory(FSpoutSenderDirectoryMapping::Get())
+	, SenderName(InSenderName)
+{
+}
+
+bool FSpoutSenderDirectoryLookup::Update()
+{
+	if (!Directory->IsOpen())
+		return false;
+
+	const SpoutSenderDirectory::FLayout& Layout = Directory->GetLayout();
+
+	if (Slot != SpoutSenderDirectory::NoSlot)
+	{
+		if (SpoutSenderDirectory::GetGeneration(Layout, Slot) == Generation)
+			return true;
+
+		// Removed, or reused by another sender since
+		if (SpoutSenderDirectory::Read(Layout, Slot, Info, &Generation)
+			&& SpoutSenderDirectory::IsSameSender(Info.Name, SenderName.c_str()))
+			return true;
+
+		Slot = SpoutSenderDirectory::NoSlot;
+		bSearched = false;
+	}
+
+	// Read before searching, a sender registering meanwhile changes it and is found next time
+	const uint32 DirectoryGeneration = SpoutSenderDirectory::GetDirectoryGeneration(Layout);
+	if (bSearched && DirectoryGeneration == SearchedDirectoryGeneration)
+		return false;
+
+	Slot = SpoutSenderDirectory::Find(Layout, SenderName.c_str(), Info, &Generation);
+	bSearched = Slot == SpoutSenderDirectory::NoSlot;
+	SearchedDirectoryGeneration = DirectoryGeneration;
+	return Slot != SpoutSenderDirectory::NoSlot;
+}
@@ -0,0 +1,79 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpoutSenderDirectory.h"
+#include "SpoutSharedMemory.h"
+
+/**
+ * The sender directory of this machine, see SpoutSenderDirectory, in the shared memory "Spout2Media_SenderDirectory".
+ * Mapped by the first sender or receiver of the process and unmapped with the last one.
+ */
+class FSpoutSenderDirectoryMapping
+{
+public:
+	// Shared mapping, created on first use. Safe to call from any thread.
+	static TSharedPtr<FSpoutSenderDirectoryMapping, ESPMode::ThreadSafe> Get();
+
+	FSpoutSenderDirectoryMapping();
+
+	bool IsOpen() const { return Layout != nullptr; }
+	SpoutSenderDirectory::FLayout& GetLayout() const { check(Layout); return *Layout; }
+
+private:
+	FSpoutSharedMemory Memory;
+	SpoutSenderDirectory::FLayout* Layout = nullptr;
+};
+
+/**
+ * Entry of one sender, registered on the first Register and removed by Unregister or on destruction.
+ */
+class FSpoutSenderDirectoryEntry
+{
+public:
+	~FSpoutSenderDirectoryEntry();
+
+	// Adds the sender or updates its entry. Receivers are notified of every update and the directory of
+	// additions, removals and changes of size or format.
+	void Register(const SpoutSenderDirectory::FSenderInfo& Info);
+	void Unregister();
+
+	bool IsRegistered() const { return Slot != SpoutSenderDirectory::NoSlot; }
+
+private:
+	TSharedPtr<FSpoutSenderDirectoryMapping, ESPMode::ThreadSafe> Directory;
+	uint32 Slot = SpoutSenderDirectory::NoSlot;
+};
+
+/**
+ * Receiver side lookup of one sender. The entry is found once, afterwards Update only compares its
+ * generation and reads it again when it changed. While the sender is not registered, the directory is
+ * only searched again after it changed.
+ */
+class FSpoutSenderDirectoryLookup
+{
+public:
+	// Name with or without the frame rate suffix
+	explicit FSpoutSenderDirectoryLookup(const char* SenderName);
+
+	// Whether the sender is registered, GetInfo then describes it
+	bool Update();
+
+	const SpoutSenderDirectory::FSenderInfo& GetInfo() const { return Info; }
+
+	// Changes whenever the entry was read again
+	uint32 GetGeneration() const { return Generation; }
+
+private:
+	TSharedPtr<FSpoutSenderDirectoryMapping, ESPMode::ThreadSafe> Directory;
+	std::string SenderName;
+
+	uint32 Slot = SpoutSenderDirectory::NoSlot;
+	uint32 Generation = 0;
+	SpoutSenderDirectory::FSenderInfo Info;
+
+	// Directory generation of the last search that did not find the sender
+	bool bSearched = false;
+	uint32 SearchedDirectoryGeneration = 0;
+};
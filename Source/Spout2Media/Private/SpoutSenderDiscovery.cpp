@@ -0,0 +1,289 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SpoutSenderDiscovery.h"
+
+#include "HAL/Event.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/RunnableThread.h"
+
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include "Spout.h"
+#include "Windows/HideWindowsPlatformTypes.h"
+
+#include "Spout2MediaStats.h"
+#include "Spout2MediaTransport.h"
+#include "SpoutSenderDirectoryMapping.h"
+
+static TAutoConsoleVariable<int32> CVarSpoutDiscoveryScanInterval(
+	TEXT("Spout2Media.Discovery.ScanIntervalMs"),
+	100,
+	TEXT("How often the discovery service checks present Spout senders for changes, in milliseconds."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarSpoutDiscoveryMaxBackoff(
+	TEXT("Spout2Media.Discovery.MaxBackoffMs"),
+	1000,
+	TEXT("Longest wait between looks for a missing Spout sender, in milliseconds. The wait doubles from 10 ms after each miss."),
+	ECVF_Default);
+
+namespace
+{
+	constexpr double MinBackoffSeconds = 0.01;
+
+	// Longest sleep while watching, the directory generation is checked at least this often
+	constexpr double DirectoryPollSeconds = 0.01;
+}
+
+FSpoutSenderDiscovery::FSpoutSenderDiscovery()
+	: Directory(FSpoutSenderDirectoryMapping::Get())
+	, WakeEvent(FPlatformProcess::GetSynchEventFromPool(false))
+	, bStopping(false)
+{
+	if (Directory->IsOpen())
+	{
+		LastDirectoryGeneration = SpoutSenderDirectory::GetDirectoryGeneration(Directory->GetLayout());
+	}
+
+	Thread = FRunnableThread::Create(this, TEXT("SpoutSenderDiscovery"), 0, TPri_BelowNormal);
+}
+
+FSpoutSenderDiscovery::~FSpoutSenderDiscovery()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+uint32 FSpoutSenderDiscovery::Subscribe(const FString& SenderName, FCallback Callback)
+{
+	const FSubscriberPtr Subscriber = MakeShared<FSubscriber, ESPMode::ThreadSafe>();
+	Subscriber->Callback = MoveTemp(Callback);
+
+	// Held until the Added event went out, events the discovery thread finds meanwhile are delivered after it
+	FScopeLock CallbackLock(&Subscriber->CallbackLock);
+
+	bool bPresent = false;
+	FSpoutSenderDescription Sender;
+	{
+		FScopeLock Lock(&WatchesLock);
+
+		TUniquePtr<FWatch>& Watch = Watches.FindOrAdd(SenderName);
+		if (!Watch)
+		{
+			Watch = MakeUnique<FWatch>();
+			Watch->SenderName = StringCast<ANSICHAR>(*SenderName).Get();
+			Watch->Lookup = MakeUnique<FSpoutSenderDirectoryLookup>(Watch->SenderName.c_str());
+			Watch->Backoff = MinBackoffSeconds;
+			WakeEvent->Trigger();
+		}
+
+		Subscriber->Id = NextSubscriptionId++;
+		Watch->Subscribers.Add(Subscriber);
+
+		bPresent = Watch->bPresent;
+		Sender = Watch->Sender;
+	}
+
+	if (bPresent)
+	{
+		Subscriber->Callback(ESpoutSenderEvent::Added, Sender);
+	}
+
+	return Subscriber->Id;
+}
+
+void FSpoutSenderDiscovery::Unsubscribe(uint32 SubscriptionId)
+{
+	FSubscriberPtr Subscriber;
+	{
+		FScopeLock Lock(&WatchesLock);
+
+		for (auto It = Watches.CreateIterator(); It; ++It)
+		{
+			TArray<FSubscriberPtr>& Subscribers = It.Value()->Subscribers;
+			const int32 Index = Subscribers.IndexOfByPredicate([SubscriptionId](const FSubscriberPtr& Other) { return Other->Id == SubscriptionId; });
+			if (Index == INDEX_NONE)
+				continue;
+
+			Subscriber = Subscribers[Index];
+			Subscribers.RemoveAt(Index);
+
+			if (Subscribers.Num() == 0)
+			{
+				It.RemoveCurrent();
+			}
+			break;
+		}
+	}
+
+	// Waits for a call in progress, events collected before the removal are dropped on delivery
+	if (Subscriber)
+	{
+		FScopeLock CallbackLock(&Subscriber->CallbackLock);
+		Subscriber->bUnsubscribed = true;
+	}
+}
+
+uint32 FSpoutSenderDiscovery::Run()
+{
+	// Kept for the thread's lifetime, so Spout opens its sender list once instead of on every scan
+	spoutSenderNames SenderNames;
+	TArray<FPendingEvent> Events;
+
+	while (!bStopping)
+	{
+		const double Now = FPlatformTime::Seconds();
+		double NextScanTime = Now + DirectoryPollSeconds;
+		bool bWatching = false;
+
+		{
+			FScopeLock Lock(&WatchesLock);
+
+			// A sender of this plugin registered, left or resized, look at every watched sender again
+			bool bDirectoryChanged = false;
+			if (Directory->IsOpen())
+			{
+				const uint32 DirectoryGeneration = SpoutSenderDirectory::GetDirectoryGeneration(Directory->GetLayout());
+				bDirectoryChanged = DirectoryGeneration != LastDirectoryGeneration;
+				LastDirectoryGeneration = DirectoryGeneration;
+			}
+
+			for (const TPair<FString, TUniquePtr<FWatch>>& Pair : Watches)
+			{
+				FWatch& Watch = *Pair.Value;
+				if (bDirectoryChanged)
+				{
+					Watch.NextScanTime = Now;
+					Watch.Backoff = MinBackoffSeconds;
+				}
+
+				if (Now >= Watch.NextScanTime)
+				{
+					Scan(Watch, Now, SenderNames, Events);
+				}
+
+				NextScanTime = FMath::Min(NextScanTime, Watch.NextScanTime);
+			}
+
+			bWatching = Watches.Num() > 0;
+		}
+
+		// Subscribers may take their own locks, or wait on threads that subscribe meanwhile
+		Deliver(Events);
+
+		// Woken early by new subscriptions and Stop
+		if (bWatching)
+		{
+			const double WaitSeconds = NextScanTime - FPlatformTime::Seconds();
+			if (WaitSeconds > 0.0)
+			{
+				WakeEvent->Wait(FTimespan::FromSeconds(WaitSeconds));
+			}
+		}
+		else
+		{
+			WakeEvent->Wait();
+		}
+	}
+
+	return 0;
+}
+
+void FSpoutSenderDiscovery::Stop()
+{
+	bStopping = true;
+	WakeEvent->Trigger();
+}
+
+void FSpoutSenderDiscovery::Scan(FWatch& Watch, double Now, spoutSenderNames& SenderNames, TArray<FPendingEvent>& OutEvents)
+{
+	INC_DWORD_STAT(STAT_Spout2Media_DiscoveryScans);
+
+	// Senders of this plugin are in the directory, others only in the Spout sender list
+	FSpoutSenderDescription Sender;
+	bool bFound = false;
+
+	if (Watch.Lookup->Update()
+		&& Watch.Lookup->GetInfo().Transport == static_cast<uint32>(ESpout2MediaTransport::SharedTexture))
+	{
+		const SpoutSenderDirectory::FSenderInfo& Info = Watch.Lookup->GetInfo();
+		Sender.Width = Info.Width;
+		Sender.Height = Info.Height;
+		Sender.Format = Info.Format;
+		Sender.ShareHandle = Info.ShareHandle;
+		bFound = true;
+	}
+	else
+	{
+		unsigned int Width = 0, Height = 0;
+		HANDLE ShareHandle = nullptr;
+		DWORD Format = 0;
+
+		if (SenderNames.FindSender(Watch.SenderName.c_str(), Width, Height, ShareHandle, Format))
+		{
+			Sender.Width = Width;
+			Sender.Height = Height;
+			Sender.Format = Format;
+			Sender.ShareHandle = static_cast<uint32>(reinterpret_cast<UPTRINT>(ShareHandle));
+			bFound = true;
+		}
+	}
+
+	if (bFound)
+	{
+		Watch.NextScanTime = Now + FMath::Max(CVarSpoutDiscoveryScanInterval.GetValueOnAnyThread(), 1) / 1000.0;
+		Watch.Backoff = MinBackoffSeconds;
+	}
+	else
+	{
+		const double MaxBackoff = FMath::Max(CVarSpoutDiscoveryMaxBackoff.GetValueOnAnyThread() / 1000.0, MinBackoffSeconds);
+		Watch.NextScanTime = Now + Watch.Backoff;
+		Watch.Backoff = FMath::Min(Watch.Backoff * 2.0, MaxBackoff);
+	}
+
+	ESpoutSenderEvent Event;
+	if (bFound && !Watch.bPresent)
+	{
+		Event = ESpoutSenderEvent::Added;
+	}
+	else if (!bFound && Watch.bPresent)
+	{
+		Event = ESpoutSenderEvent::Removed;
+	}
+	else if (bFound && Sender != Watch.Sender)
+	{
+		Event = ESpoutSenderEvent::Resized;
+	}
+	else
+	{
+		return;
+	}
+
+	Watch.bPresent = bFound;
+	Watch.Sender = bFound ? Sender : FSpoutSenderDescription();
+
+	for (const FSubscriberPtr& Subscriber : Watch.Subscribers)
+	{
+		OutEvents.Add({ Subscriber, Event, Watch.Sender });
+	}
+}
+
+void FSpoutSenderDiscovery::Deliver(TArray<FPendingEvent>& Events)
+{
+	for (const FPendingEvent& Pending : Events)
+	{
+		FScopeLock CallbackLock(&Pending.Subscriber->CallbackLock);
+		if (!Pending.Subscriber->bUnsubscribed)
+		{
+			Pending.Subscriber->Callback(Pending.Event, Pending.Sender);
+		}
+	}
+
+	Events.Reset();
+}
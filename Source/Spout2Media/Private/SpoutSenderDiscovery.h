@@ -0,0 +1,125 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+
+#include <string>
+
+class FEvent;
+class FRunnableThread;
+class FSpoutSenderDirectoryLookup;
+class FSpoutSenderDirectoryMapping;
+class spoutSenderNames;
+
+enum class ESpoutSenderEvent : uint8
+{
+	Added,
+	Removed,
+	// Size, format or shared texture changed
+	Resized,
+};
+
+// Shared texture of a sender as the discovery service last saw it
+struct FSpoutSenderDescription
+{
+	uint32 Width = 0;
+	uint32 Height = 0;
+	uint32 Format = 0;
+	uint32 ShareHandle = 0;
+
+	bool operator==(const FSpoutSenderDescription& Other) const
+	{
+		return Width == Other.Width && Height == Other.Height && Format == Other.Format && ShareHandle == Other.ShareHandle;
+	}
+
+	bool operator!=(const FSpoutSenderDescription& Other) const { return !(*this == Other); }
+};
+
+/**
+ * Watches the Spout senders players asked for on one background thread, so the cost of looking for
+ * senders grows with the number of distinct senders instead of the number of players. Present senders are
+ * checked every Spout2Media.Discovery.ScanIntervalMs, missing ones with an exponential backoff up to
+ * Spout2Media.Discovery.MaxBackoffMs. Senders of this plugin are found in the sender directory, whose
+ * changes are checked every few milliseconds and rescan every watched sender right away.
+ *
+ * Owned by FSpout2MediaModule, see FSpout2MediaModule::GetSenderDiscovery.
+ */
+class FSpoutSenderDiscovery
+	: public FRunnable
+{
+public:
+	// Called on the discovery thread, or in Subscribe for a sender that is already there. Never while the
+	// discovery holds its own lock, but must not subscribe or unsubscribe itself, Unsubscribe waits for it.
+	using FCallback = TFunction<void(ESpoutSenderEvent Event, const FSpoutSenderDescription& Sender)>;
+
+	FSpoutSenderDiscovery();
+	virtual ~FSpoutSenderDiscovery() override;
+
+	// Watches the sender going by SenderName, Callback gets an Added event right away when it is there.
+	// Returns the id to unsubscribe with.
+	uint32 Subscribe(const FString& SenderName, FCallback Callback);
+
+	// Once this returns, the callback is not running and is not called again. Waits for a call in progress.
+	void Unsubscribe(uint32 SubscriptionId);
+
+	//~ FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	struct FSubscriber
+	{
+		uint32 Id = 0;
+		FCallback Callback;
+
+		// Held while Callback runs, Unsubscribe takes it to wait for a call in progress
+		FCriticalSection CallbackLock;
+		bool bUnsubscribed = false;
+	};
+
+	using FSubscriberPtr = TSharedPtr<FSubscriber, ESPMode::ThreadSafe>;
+
+	// Change found by a scan, delivered once WatchesLock is released
+	struct FPendingEvent
+	{
+		FSubscriberPtr Subscriber;
+		ESpoutSenderEvent Event;
+		FSpoutSenderDescription Sender;
+	};
+
+	struct FWatch
+	{
+		std::string SenderName;
+		TUniquePtr<FSpoutSenderDirectoryLookup> Lookup;
+
+		bool bPresent = false;
+		FSpoutSenderDescription Sender;
+
+		// When to look again, and how long to wait after the next miss
+		double NextScanTime = 0.0;
+		double Backoff = 0.0;
+
+		TArray<FSubscriberPtr> Subscribers;
+	};
+
+	// Looks for the sender and adds what changed for its subscribers to OutEvents. SenderNames is the
+	// discovery thread's, kept across scans.
+	void Scan(FWatch& Watch, double Now, spoutSenderNames& SenderNames, TArray<FPendingEvent>& OutEvents);
+
+	// Calls back each subscriber that was not unsubscribed meanwhile, without WatchesLock held
+	static void Deliver(TArray<FPendingEvent>& Events);
+
+	// Watches by sender name, held while scanning but not while calling back
+	TMap<FString, TUniquePtr<FWatch>> Watches;
+	FCriticalSection WatchesLock;
+	uint32 NextSubscriptionId = 1;
+
+	TSharedPtr<FSpoutSenderDirectoryMapping, ESPMode::ThreadSafe> Directory;
+	uint32 LastDirectoryGeneration = 0;
+
+	FEvent* WakeEvent = nullptr;
+	FRunnableThread* Thread = nullptr;
+	TAtomic<bool> bStopping;
+};
@@ -0,0 +1,69 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SpoutSharedBuffers.h"
+
+FSpoutSharedBufferMapping::~FSpoutSharedBufferMapping()
+{
+	Close();
+}
+
+std::string FSpoutSharedBufferMapping::GetMappingName(const std::string& SenderName)
+{
+	return SenderName + "_SpoutBuffers";
+}
+
+bool FSpoutSharedBufferMapping::Create(const std::string& SenderName, uint32 NumBuffers)
+{
+	Close();
+
+	Mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+		0, sizeof(SpoutBufferIndex::FLayout), GetMappingName(SenderName).c_str());
+	if (!Mapping)
+		return false;
+
+	Layout = static_cast<SpoutBufferIndex::FLayout*>(
+		MapViewOfFile(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SpoutBufferIndex::FLayout)));
+	if (!Layout)
+	{
+		Close();
+		return false;
+	}
+
+	// A receiver may still hold the mapping of a previous sender with this name, start over either way
+	SpoutBufferIndex::Initialize(*Layout, FMath::Clamp<uint32>(NumBuffers, 1, SpoutBufferIndex::MaxBuffers));
+	return true;
+}
+
+bool FSpoutSharedBufferMapping::Open(const std::string& SenderName)
+{
+	Close();
+
+	Mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, false, GetMappingName(SenderName).c_str());
+	if (!Mapping)
+		return false;
+
+	Layout = static_cast<SpoutBufferIndex::FLayout*>(
+		MapViewOfFile(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SpoutBufferIndex::FLayout)));
+	if (!Layout || !SpoutBufferIndex::IsValid(*Layout))
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void FSpoutSharedBufferMapping::Close()
+{
+	if (Layout)
+	{
+		UnmapViewOfFile(Layout);
+		Layout = nullptr;
+	}
+
+	if (Mapping)
+	{
+		CloseHandle(Mapping);
+		Mapping = nullptr;
+	}
+}
@@ -0,0 +1,39 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpoutBufferIndex.h"
+
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <Windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+
+#include <string>
+
+/**
+ * Named file mapping holding the SpoutBufferIndex layout of a multi-buffered sender, "<sender name>_SpoutBuffers".
+ * Created by the sender, opened by receivers. Senders without one publish a single texture the usual Spout way.
+ */
+class FSpoutSharedBufferMapping
+{
+public:
+	~FSpoutSharedBufferMapping();
+
+	// Sender side, creates the mapping and clears the layout for NumBuffers buffers
+	bool Create(const std::string& SenderName, uint32 NumBuffers);
+
+	// Receiver side, false when the sender has no mapping or has not finished initializing it
+	bool Open(const std::string& SenderName);
+
+	void Close();
+
+	bool IsOpen() const { return Layout != nullptr; }
+	SpoutBufferIndex::FLayout& GetLayout() const { check(Layout); return *Layout; }
+
+private:
+	static std::string GetMappingName(const std::string& SenderName);
+
+	HANDLE Mapping = nullptr;
+	SpoutBufferIndex::FLayout* Layout = nullptr;
+};
@@ -0,0 +1,177 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SpoutSharedMemory.h"
+
+#include <cstdint>
+
+#if defined(_WIN32)
+#include "CoreMinimal.h"
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <Windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+FSpoutSharedMemory::~FSpoutSharedMemory()
+{
+	Close();
+}
+
+#if defined(_WIN32)
+
+bool FSpoutSharedMemory::Create(const std::string& Name, size_t InSize, bool bKeepName)
+{
+	Close();
+
+	const uint64_t MappingSize = InSize;
+	Mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+		static_cast<DWORD>(MappingSize >> 32), static_cast<DWORD>(MappingSize), Name.c_str());
+	if (!Mapping)
+		return false;
+
+	Data = MapViewOfFile(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, InSize);
+	if (!Data)
+	{
+		Close();
+		return false;
+	}
+
+	Size = InSize;
+	return true;
+}
+
+bool FSpoutSharedMemory::Open(const std::string& Name)
+{
+	Close();
+
+	Mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, false, Name.c_str());
+	if (!Mapping)
+		return false;
+
+	Data = MapViewOfFile(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+
+	MEMORY_BASIC_INFORMATION Info;
+	if (!Data || VirtualQuery(Data, &Info, sizeof(Info)) == 0)
+	{
+		Close();
+		return false;
+	}
+
+	// Whole pages, the creator's size is at most this
+	Size = Info.RegionSize;
+	return true;
+}
+
+void FSpoutSharedMemory::Close()
+{
+	if (Data)
+	{
+		UnmapViewOfFile(Data);
+		Data = nullptr;
+	}
+
+	if (Mapping)
+	{
+		CloseHandle(Mapping);
+		Mapping = nullptr;
+	}
+
+	Size = 0;
+}
+
+#else
+
+namespace
+{
+	// POSIX names are a single component starting with a slash
+	std::string GetObjectName(const std::string& Name)
+	{
+		std::string ObjectName = "/" + Name;
+		for (size_t Index = 1; Index < ObjectName.size(); Index++)
+		{
+			if (ObjectName[Index] == '/')
+				ObjectName[Index] = '_';
+		}
+		return ObjectName;
+	}
+}
+
+bool FSpoutSharedMemory::Create(const std::string& Name, size_t InSize, bool bKeepName)
+{
+	Close();
+
+	const std::string ObjectName = GetObjectName(Name);
+	const int File = shm_open(ObjectName.c_str(), O_CREAT | O_RDWR, 0600);
+	if (File < 0)
+		return false;
+
+	if (ftruncate(File, static_cast<off_t>(InSize)) != 0)
+	{
+		close(File);
+		return false;
+	}
+
+	void* Mapped = mmap(nullptr, InSize, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+	close(File);
+
+	if (Mapped == MAP_FAILED)
+		return false;
+
+	Data = Mapped;
+	Size = InSize;
+	if (!bKeepName)
+	{
+		OwnedName = ObjectName;
+	}
+	return true;
+}
+
+bool FSpoutSharedMemory::Open(const std::string& Name)
+{
+	Close();
+
+	const int File = shm_open(GetObjectName(Name).c_str(), O_RDWR, 0);
+	if (File < 0)
+		return false;
+
+	struct stat Stat;
+	if (fstat(File, &Stat) != 0 || Stat.st_size <= 0)
+	{
+		close(File);
+		return false;
+	}
+
+	void* Mapped = mmap(nullptr, static_cast<size_t>(Stat.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+	close(File);
+
+	if (Mapped == MAP_FAILED)
+		return false;
+
+	Data = Mapped;
+	Size = static_cast<size_t>(Stat.st_size);
+	return true;
+}
+
+void FSpoutSharedMemory::Close()
+{
+	if (Data)
+	{
+		munmap(Data, Size);
+		Data = nullptr;
+	}
+
+	// Readers keep their mapping, the name is free for the next sender
+	if (!OwnedName.empty())
+	{
+		shm_unlink(OwnedName.c_str());
+		OwnedName.clear();
+	}
+
+	Size = 0;
+}
+
+#endif
@@ -0,0 +1,41 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Standard C++ only, so the POSIX side builds headless together with SpoutFrameRing.
+#include <cstddef>
+#include <string>
+
+/**
+ * Named block of shared memory, a file mapping on Windows and a POSIX shared memory object elsewhere.
+ * Created by one process, opened by others by name.
+ */
+class FSpoutSharedMemory
+{
+public:
+	~FSpoutSharedMemory();
+
+	// Creates the block. A block of this name left behind by another owner is reused, and fails on Windows when smaller than Size.
+	// bKeepName leaves the name behind on Close, for blocks every side creates and none owns.
+	bool Create(const std::string& Name, size_t Size, bool bKeepName = false);
+
+	// Opens a block another process created, false when there is none
+	bool Open(const std::string& Name);
+
+	void Close();
+
+	bool IsOpen() const { return Data != nullptr; }
+	void* GetData() const { return Data; }
+	size_t GetSize() const { return Size; }
+
+private:
+	void* Data = nullptr;
+	size_t Size = 0;
+
+#if defined(_WIN32)
+	void* Mapping = nullptr;
+#else
+	// Created blocks are unlinked on Close, opened ones only unmapped
+	std::string OwnedName;
+#endif
+};
@@ -0,0 +1,273 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Standard C++ only, so transports build and run headless on any platform.
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "SpoutFrameRing.h"
+
+/**
+ * Transports that move CPU frames from a sender to receivers by sender name. Senders write a frame in
+ * place between BeginFrame and EndFrame, receivers acquire the latest frame as a shared reference that
+ * stays valid for as long as they hold it.
+ *
+ * The Spout shared texture path stays outside of this, its frames never leave the GPU.
+ */
+namespace SpoutTransport
+{
+	using FFrameInfo = SpoutFrameRing::FFrameInfo;
+
+	struct FFrame
+	{
+		FFrameInfo Info;
+		std::vector<uint8_t> Data;
+	};
+
+	using FFramePtr = std::shared_ptr<const FFrame>;
+
+	class ISender
+	{
+	public:
+		virtual ~ISender() {}
+
+		// Memory for the next frame of Size bytes, nullptr when it cannot take one
+		virtual uint8_t* BeginFrame(uint32_t Size) = 0;
+
+		// Publishes the frame begun last, returns its frame number
+		virtual uint64_t EndFrame(const FFrameInfo& Info) = 0;
+	};
+
+	class IReceiver
+	{
+	public:
+		virtual ~IReceiver() {}
+
+		// Whether the sender was found, receivers keep looking for it on each acquire
+		virtual bool IsConnected() const = 0;
+
+		// The latest frame if it is newer than AfterFrame, nullptr otherwise. Frame numbers start over when
+		// the receiver finds a new sender under the name, its first frame is returned whatever AfterFrame is.
+		virtual FFramePtr AcquireLatest(uint64_t AfterFrame) = 0;
+	};
+
+	class ITransport
+	{
+	public:
+		virtual ~ITransport() {}
+
+		virtual const char* GetName() const = 0;
+
+		// MaxFrameSize bounds the frames transports with fixed slots can carry
+		virtual std::unique_ptr<ISender> CreateSender(const std::string& SenderName, uint64_t MaxFrameSize) = 0;
+		virtual std::unique_ptr<IReceiver> CreateReceiver(const std::string& SenderName) = 0;
+
+		// Names of the senders currently publishing, empty for transports that cannot list them
+		virtual void GetSenderNames(std::vector<std::string>& OutNames) = 0;
+	};
+
+	/**
+	 * Connects senders and receivers of one process without copying: a receiver gets a reference to the
+	 * very frame the sender wrote. The sender recycles frames once no receiver holds them anymore.
+	 *
+	 * Spout2MediaStandaloneTests/SpoutLoopbackTransportBenchmark.cpp measures its throughput and latency.
+	 */
+	class FLoopbackTransport
+		: public ITransport
+	{
+		struct FChannel
+		{
+			std::mutex Lock;
+			std::shared_ptr<FFrame> Latest;
+			uint64_t FrameNumber = 0;
+
+			// Set when the sender went away, receivers then look the name up again
+			bool bClosed = false;
+		};
+
+		class FSender
+			: public ISender
+		{
+		public:
+			FSender(FLoopbackTransport& InTransport, const std::string& InName, std::shared_ptr<FChannel> InChannel, uint64_t InMaxFrameSize)
+				: Transport(InTransport)
+				, Name(InName)
+				, Channel(std::move(InChannel))
+				, MaxFrameSize(size_t(InMaxFrameSize))
+			{
+			}
+
+			virtual ~FSender() override
+			{
+				Transport.RemoveChannel(Name, Channel);
+
+				std::lock_guard<std::mutex> Guard(Channel->Lock);
+				Channel->bClosed = true;
+				Channel->Latest.reset();
+			}
+
+			virtual uint8_t* BeginFrame(uint32_t Size) override
+			{
+				Writing = nullptr;
+
+				// Free once only the pool references it, receivers only ever get the latest frame
+				for (const std::shared_ptr<FFrame>& Frame : Pool)
+				{
+					if (Frame.use_count() == 1)
+					{
+						Writing = Frame;
+						break;
+					}
+				}
+
+				if (!Writing)
+				{
+					if (Pool.size() == MaxPoolSize)
+						return nullptr;
+
+					// Sized once for the largest frame, so frames changing size do not reallocate
+					Writing = std::make_shared<FFrame>();
+					Writing->Data.reserve(std::max<size_t>(MaxFrameSize, Size));
+					Pool.push_back(Writing);
+				}
+
+				Writing->Data.resize(Size);
+				return Writing->Data.data();
+			}
+
+			virtual uint64_t EndFrame(const FFrameInfo& Info) override
+			{
+				if (!Writing)
+					return 0;
+
+				std::lock_guard<std::mutex> Guard(Channel->Lock);
+				Writing->Info = Info;
+				Writing->Info.FrameNumber = ++Channel->FrameNumber;
+				Writing->Info.Size = uint32_t(std::min<size_t>(Info.Size, Writing->Data.size()));
+				Channel->Latest = std::move(Writing);
+				return Channel->FrameNumber;
+			}
+
+		private:
+			// Frames held by receivers, plus the latest one and the one being written
+			static constexpr size_t MaxPoolSize = 8;
+
+			FLoopbackTransport& Transport;
+			std::string Name;
+			std::shared_ptr<FChannel> Channel;
+			size_t MaxFrameSize;
+
+			std::vector<std::shared_ptr<FFrame>> Pool;
+			std::shared_ptr<FFrame> Writing;
+		};
+
+		class FReceiver
+			: public IReceiver
+		{
+		public:
+			FReceiver(FLoopbackTransport& InTransport, const std::string& InName)
+				: Transport(InTransport)
+				, Name(InName)
+			{
+			}
+
+			virtual bool IsConnected() const override { return Channel != nullptr; }
+
+			virtual FFramePtr AcquireLatest(uint64_t AfterFrame) override
+			{
+				if (!Channel)
+				{
+					Channel = Transport.FindChannel(Name);
+					if (!Channel)
+						return nullptr;
+
+					bFirstFrame = true;
+				}
+
+				// Keeps the channel alive while its lock is held
+				const std::shared_ptr<FChannel> Current = Channel;
+				std::lock_guard<std::mutex> Guard(Current->Lock);
+
+				// A new sender under the name gets a new channel
+				if (Current->bClosed)
+				{
+					Channel.reset();
+					return nullptr;
+				}
+
+				if (!Current->Latest || (!bFirstFrame && Current->Latest->Info.FrameNumber <= AfterFrame))
+					return nullptr;
+
+				bFirstFrame = false;
+				return Current->Latest;
+			}
+
+		private:
+			FLoopbackTransport& Transport;
+			std::string Name;
+			std::shared_ptr<FChannel> Channel;
+
+			// Frame numbers start over with each sender, the first frame of a channel is always new
+			bool bFirstFrame = false;
+		};
+
+	public:
+		virtual const char* GetName() const override { return "Loopback"; }
+
+		// nullptr when another sender of this process already uses the name
+		virtual std::unique_ptr<ISender> CreateSender(const std::string& SenderName, uint64_t MaxFrameSize) override
+		{
+			std::lock_guard<std::mutex> Guard(ChannelsLock);
+
+			std::shared_ptr<FChannel>& Channel = Channels[SenderName];
+			if (Channel)
+				return nullptr;
+
+			Channel = std::make_shared<FChannel>();
+			return std::make_unique<FSender>(*this, SenderName, Channel, MaxFrameSize);
+		}
+
+		virtual std::unique_ptr<IReceiver> CreateReceiver(const std::string& SenderName) override
+		{
+			return std::make_unique<FReceiver>(*this, SenderName);
+		}
+
+		virtual void GetSenderNames(std::vector<std::string>& OutNames) override
+		{
+			std::lock_guard<std::mutex> Guard(ChannelsLock);
+			for (const auto& Channel : Channels)
+			{
+				OutNames.push_back(Channel.first);
+			}
+		}
+
+	private:
+		std::shared_ptr<FChannel> FindChannel(const std::string& Name)
+		{
+			std::lock_guard<std::mutex> Guard(ChannelsLock);
+
+			auto Found = Channels.find(Name);
+			return Found != Channels.end() ? Found->second : nullptr;
+		}
+
+		void RemoveChannel(const std::string& Name, const std::shared_ptr<FChannel>& Channel)
+		{
+			std::lock_guard<std::mutex> Guard(ChannelsLock);
+
+			auto Found = Channels.find(Name);
+			if (Found != Channels.end() && Found->second == Channel)
+			{
+				Channels.erase(Found);
+			}
+		}
+
+		std::mutex ChannelsLock;
+		std::map<std::string, std::shared_ptr<FChannel>> Channels;
+	};
+}
@@ -0,0 +1,197 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SpoutTransportRegistry.h"
+
+#include "SpoutSenderDirectoryMapping.h"
+#include "SpoutSharedMemory.h"
+
+namespace
+{
+	// Named shared memory ring "<sender name>_SpoutFrames" per sender, see SpoutFrameRing
+	class FSharedMemoryTransport
+		: public SpoutTransport::ITransport
+	{
+		static std::string GetRingName(const std::string& SenderName) { return SenderName + "_SpoutFrames"; }
+
+		class FSender
+			: public SpoutTransport::ISender
+		{
+		public:
+			// Frames kept in the ring, a receiver that falls this far behind skips to the latest
+			static constexpr uint32 NumRingSlots = 3;
+
+			bool Create(const std::string& SenderName, uint64 MaxFrameSize)
+			{
+				if (!Memory.Create(GetRingName(SenderName), SpoutFrameRing::GetRequiredSize(NumRingSlots, MaxFrameSize)))
+					return false;
+
+				Writer = MakeUnique<SpoutFrameRing::FWriter>(SpoutFrameRing::Initialize(Memory.GetData(), NumRingSlots, MaxFrameSize));
+				return true;
+			}
+
+			virtual uint8* BeginFrame(uint32 Size) override
+			{
+				return Size <= Writer->GetSlotCapacity() ? Writer->BeginWrite() : nullptr;
+			}
+
+			virtual uint64 EndFrame(const SpoutTransport::FFrameInfo& Info) override
+			{
+				return Writer->EndWrite(Info);
+			}
+
+		private:
+			FSpoutSharedMemory Memory;
+			TUniquePtr<SpoutFrameRing::FWriter> Writer;
+		};
+
+		class FReceiver
+			: public SpoutTransport::IReceiver
+		{
+		public:
+			explicit FReceiver(const std::string& SenderName)
+				: RingName(GetRingName(SenderName))
+			{
+			}
+
+			virtual bool IsConnected() const override { return Reader.IsValid(); }
+
+			virtual SpoutTransport::FFramePtr AcquireLatest(uint64 AfterFrame) override
+			{
+				const double Now = FPlatformTime::Seconds();
+
+				// A restarted sender may have recreated the ring, the old one never gets another frame
+				if (Reader && Now - LastFrameTime > ReopenSeconds)
+				{
+					Close();
+				}
+
+				if (!Reader && !Open(Now))
+					return nullptr;
+
+				// Started over by a new sender reusing the mapping
+				if (Reader->GetLatestFrameNumber() < AfterFrame)
+				{
+					bFirstFrame = true;
+				}
+
+				std::shared_ptr<SpoutTransport::FFrame> Frame = AcquireFreeFrame();
+				if (!Frame)
+					return nullptr;
+
+				const uint64 ReadAfter = bFirstFrame ? 0 : AfterFrame;
+				SpoutFrameRing::EReadResult Result = Reader->ReadLatest(ReadAfter, Frame->Info, Frame->Data.data(), Frame->Data.size());
+				if (Result == SpoutFrameRing::EReadResult::TooLarge)
+				{
+					Frame->Data.resize(Frame->Info.Size);
+					Result = Reader->ReadLatest(ReadAfter, Frame->Info, Frame->Data.data(), Frame->Data.size());
+				}
+
+				if (Result != SpoutFrameRing::EReadResult::Ok)
+					return nullptr;
+
+				bFirstFrame = false;
+				LastFrameTime = Now;
+				return Frame;
+			}
+
+		private:
+			// A sender that stops publishing for this long is looked for again
+			static constexpr double ReopenSeconds = 1.0;
+
+			// Frames the caller still holds plus the one read into
+			static constexpr size_t MaxPoolSize = 4;
+
+			bool Open(double Now)
+			{
+				if (!Memory.Open(RingName) || !SpoutFrameRing::IsValid(Memory.GetData(), Memory.GetSize()))
+				{
+					Memory.Close();
+					return false;
+				}
+
+				Reader = MakeUnique<SpoutFrameRing::FReader>(*static_cast<SpoutFrameRing::FRingHeader*>(Memory.GetData()));
+				LastFrameTime = Now;
+				bFirstFrame = true;
+				return true;
+			}
+
+			void Close()
+			{
+				Reader.Reset();
+				Memory.Close();
+			}
+
+			std::shared_ptr<SpoutTransport::FFrame> AcquireFreeFrame()
+			{
+				for (const std::shared_ptr<SpoutTransport::FFrame>& Frame : Pool)
+				{
+					if (Frame.use_count() == 1)
+						return Frame;
+				}
+
+				if (Pool.size() == MaxPoolSize)
+					return nullptr;
+
+				Pool.push_back(std::make_shared<SpoutTransport::FFrame>());
+				return Pool.back();
+			}
+
+			std::string RingName;
+			FSpoutSharedMemory Memory;
+			TUniquePtr<SpoutFrameRing::FReader> Reader;
+			std::vector<std::shared_ptr<SpoutTransport::FFrame>> Pool;
+
+			double LastFrameTime = 0.0;
+			bool bFirstFrame = true;
+		};
+
+	public:
+		virtual const char* GetName() const override { return "SharedMemory"; }
+
+		virtual std::unique_ptr<SpoutTransport::ISender> CreateSender(const std::string& SenderName, uint64 MaxFrameSize) override
+		{
+			std::unique_ptr<FSender> Sender = std::make_unique<FSender>();
+			if (!Sender->Create(SenderName, MaxFrameSize))
+				return nullptr;
+
+			return Sender;
+		}
+
+		virtual std::unique_ptr<SpoutTransport::IReceiver> CreateReceiver(const std::string& SenderName) override
+		{
+			return std::make_unique<FReceiver>(SenderName);
+		}
+
+		// Shared memory objects cannot be listed by name prefix, the capture registers its senders in the directory
+		virtual void GetSenderNames(std::vector<std::string>& OutNames) override
+		{
+			const TSharedPtr<FSpoutSenderDirectoryMapping, ESPMode::ThreadSafe> Directory = FSpoutSenderDirectoryMapping::Get();
+			if (!Directory->IsOpen())
+				return;
+
+			SpoutSenderDirectory::ForEachSender(Directory->GetLayout(), [&OutNames](uint32 Slot, const SpoutSenderDirectory::FSenderInfo& Info)
+			{
+				if (Info.Transport == static_cast<uint32>(ESpout2MediaTransport::SharedMemory))
+				{
+					OutNames.emplace_back(Info.Name);
+				}
+			});
+		}
+	};
+}
+
+SpoutTransport::ITransport* SpoutTransportRegistry::Get(ESpout2MediaTransport Type)
+{
+	static FSharedMemoryTransport SharedMemoryTransport;
+	static SpoutTransport::FLoopbackTransport LoopbackTransport;
+
+	switch (Type)
+	{
+	case ESpout2MediaTransport::SharedMemory:
+		return &SharedMemoryTransport;
+	case ESpout2MediaTransport::Loopback:
+		return &LoopbackTransport;
+	default:
+		return nullptr;
+	}
+}
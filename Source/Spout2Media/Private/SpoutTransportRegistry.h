@@ -0,0 +1,13 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Spout2MediaTransport.h"
+#include "SpoutTransport.h"
+
+namespace SpoutTransportRegistry
+{
+	// Process-wide transport of a type, nullptr for the Spout shared texture path which is not one
+	SpoutTransport::ITransport* Get(ESpout2MediaTransport Type);
+}
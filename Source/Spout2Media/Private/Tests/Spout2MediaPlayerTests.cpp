@@ -0,0 +1,384 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Async/Async.h"
+#include "HAL/MemoryBase.h"
+#include "IMediaEventSink.h"
+#include "Misc/AutomationTest.h"
+#include "RenderingThread.h"
+#include "RHICommandList.h"
+
+#include "Spout2MediaPlayer.h"
+#include "Spout2MediaSource.h"
+#include "Spout2MediaTextureSample.h"
+#include "SpoutTransportRegistry.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/** Ticks a player's receiver context on demand, instead of once per render thread frame */
+struct FSpout2MediaPlayerTestAccess
+{
+	static void TickReceiver_RenderThread(FSpout2MediaPlayer& Player, FRHICommandListImmediate& RHICmdList)
+	{
+		Player.TickReceiver_RenderThread(RHICmdList);
+	}
+
+	static void TickReceiver(FSpout2MediaPlayer& Player)
+	{
+		ENQUEUE_RENDER_COMMAND(Spout2MediaTestTickReceiver)([&Player](FRHICommandListImmediate& RHICmdList)
+		{
+			TickReceiver_RenderThread(Player, RHICmdList);
+
+			// The sample is only handed out once its copy fence passed
+			RHICmdList.ImmediateFlush(EImmediateFlushType::FlushRHIThread);
+			RHICmdList.BlockUntilGPUIdle();
+		});
+		FlushRenderingCommands();
+	}
+
+	static int32 GetNumPooledSamples(const FSpout2MediaPlayer& Player)
+	{
+		return Player.SamplePool->Num();
+	}
+
+	static int32 GetMaxPooledSamples()
+	{
+		return FSpout2MediaPlayer::MaxPooledSamples;
+	}
+};
+
+namespace Spout2MediaPlayerTests
+{
+	class FNullMediaEventSink
+		: public IMediaEventSink
+	{
+	public:
+		virtual void ReceiveMediaEvent(EMediaEvent Event) override {}
+	};
+
+	constexpr uint32 FrameWidth = 4;
+	constexpr uint32 FrameHeight = 4;
+	constexpr uint32 FrameStride = FrameWidth * 4;
+
+	/** Player receiving from a sender of the loopback transport, under a name no other test uses */
+	struct FLoopbackReceiver
+	{
+		FString SenderName = FString::Printf(TEXT("Spout2MediaTest_%s"), *FGuid::NewGuid().ToString());
+		std::unique_ptr<SpoutTransport::ISender> Sender;
+
+		FNullMediaEventSink EventSink;
+		FSpout2MediaPlayer Player{ EventSink };
+
+		FLoopbackReceiver()
+		{
+			Sender = SpoutTransportRegistry::Get(ESpout2MediaTransport::Loopback)->CreateSender(
+				TCHAR_TO_UTF8(*SenderName), FrameStride * FrameHeight);
+
+			USpout2MediaSource* Source = NewObject<USpout2MediaSource>();
+			Source->SourceName = SenderName;
+			Source->Transport = ESpout2MediaTransport::Loopback;
+			Source->BufferPolicy = ESpout2MediaSampleBufferPolicy::NewestOnly;
+			Source->FrameSyncTimeoutMs = 0;
+
+			Player.Open(Source->GetUrl(), Source);
+
+			// Registers the receiver context
+			FlushRenderingCommands();
+		}
+
+		~FLoopbackReceiver()
+		{
+			Player.Close();
+			FlushRenderingCommands();
+		}
+
+		// Publishes a BGRA frame, returns its frame number
+		uint64 Send()
+		{
+			uint8* Data = Sender->BeginFrame(FrameStride * FrameHeight);
+			if (!Data)
+				return 0;
+
+			FMemory::Memset(Data, 0xff, FrameStride * FrameHeight);
+
+			SpoutTransport::FFrameInfo Info;
+			Info.Width = FrameWidth;
+			Info.Height = FrameHeight;
+			Info.Stride = FrameStride;
+			Info.PixelFormat = PF_B8G8R8A8;
+			Info.Size = FrameStride * FrameHeight;
+			return Sender->EndFrame(Info);
+		}
+
+		// Runs one receive tick and fetches like the media framework, returns the delivered frame number or 0
+		int64 TickAndFetch()
+		{
+			FSpout2MediaPlayerTestAccess::TickReceiver(Player);
+
+			TSharedPtr<IMediaTextureSample, ESPMode::ThreadSafe> Sample;
+			if (!Player.FetchVideo(TRange<FTimespan>::All(), Sample) || !Sample)
+				return 0;
+
+			return static_cast<FSpout2MediaTextureSample*>(Sample.Get())->GetSenderFrame();
+		}
+	};
+
+	// Set on the threads whose allocations FCountingMalloc counts
+	thread_local bool bCountAllocations = false;
+
+	/**
+	 * Forwards to the engine allocator and counts the allocations made while bCountAllocations is set.
+	 * Installed as GMalloc for the duration of a test. Never destroyed, since other threads may still be
+	 * calling through it after it was uninstalled.
+	 */
+	class FCountingMalloc
+		: public FMalloc
+	{
+	public:
+		FMalloc* Inner = nullptr;
+		std::atomic<int32> NumAllocations{0};
+
+		static FCountingMalloc& Get()
+		{
+			static FCountingMalloc CountingMalloc;
+			return CountingMalloc;
+		}
+
+		void Install()
+		{
+			check(GMalloc != this);
+			Inner = GMalloc;
+			NumAllocations = 0;
+			GMalloc = this;
+		}
+
+		void Uninstall()
+		{
+			check(GMalloc == this);
+			GMalloc = Inner;
+		}
+
+		//~ FMalloc interface
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override { CountAllocation(); return Inner->Malloc(Count, Alignment); }
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override { CountAllocation(); return Inner->TryMalloc(Count, Alignment); }
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override { CountAllocation(Count); return Inner->Realloc(Original, Count, Alignment); }
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override { CountAllocation(Count); return Inner->TryRealloc(Original, Count, Alignment); }
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("Spout2MediaCountingMalloc"); }
+
+	private:
+		// Reallocating to zero bytes frees
+		void CountAllocation(SIZE_T Count = 1)
+		{
+			if (bCountAllocations && Count > 0)
+			{
+				NumAllocations++;
+			}
+		}
+	};
+
+	/** Counts the allocations the calling thread makes in its scope */
+	struct FScopedAllocationCount
+	{
+		FScopedAllocationCount() { bCountAllocations = true; }
+		~FScopedAllocationCount() { bCountAllocations = false; }
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpout2MediaPlayerFramePerTickTest, "Spout2Media.Player.FramePerTick",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSpout2MediaPlayerFramePerTickTest::RunTest(const FString& Parameters)
+{
+	Spout2MediaPlayerTests::FLoopbackReceiver Receiver;
+	if (!TestNotNull(TEXT("Loopback sender"), Receiver.Sender.get()))
+		return false;
+
+	// Frames the sender publishes before each tick, and the frame that tick delivers.
+	// A frame published before a tick is copied and handed out in that same tick.
+	struct FStep
+	{
+		int32 NumSent;
+		int64 Delivered;
+	};
+	const FStep Steps[] =
+	{
+		{ 0, 0 },	// nothing sent yet
+		{ 1, 1 },
+		{ 0, 0 },	// no new frame, frame 1 is not delivered again
+		{ 2, 3 },	// only the latest of two frames
+		{ 1, 4 },
+		{ 1, 5 },
+	};
+
+	for (int32 Tick = 0; Tick < UE_ARRAY_COUNT(Steps); Tick++)
+	{
+		for (int32 Sent = 0; Sent < Steps[Tick].NumSent; Sent++)
+		{
+			Receiver.Send();
+		}
+
+		const int64 Delivered = Receiver.TickAndFetch();
+		AddInfo(FString::Printf(TEXT("Tick %d: %d sent, frame %lld delivered"), Tick, Steps[Tick].NumSent, Delivered));
+		TestEqual(FString::Printf(TEXT("Frame delivered on tick %d"), Tick), Delivered, Steps[Tick].Delivered);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpout2MediaPlayerConcurrentFetchTest, "Spout2Media.Player.ConcurrentFetch",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSpout2MediaPlayerConcurrentFetchTest::RunTest(const FString& Parameters)
+{
+	using namespace Spout2MediaPlayerTests;
+
+	constexpr int32 NumTicks = 300;
+
+	FLoopbackReceiver Receiver;
+	if (!TestNotNull(TEXT("Loopback sender"), Receiver.Sender.get()))
+		return false;
+
+	// Like the media framework: best sample fetches on one thread, peeks on another, flushes from the test
+	std::atomic<bool> bDone{false};
+	int32 NumFetched = 0;
+	int32 NumPeeked = 0;
+	bool bFetchedInOrder = true;
+
+	TFuture<void> Fetcher = Async(EAsyncExecution::Thread, [&]()
+	{
+		const TRange<FMediaTimeStamp> TimeRange(FMediaTimeStamp(FTimespan::Zero()), FMediaTimeStamp(FTimespan::MaxValue()));
+		int64 LastFrame = 0;
+
+		while (!bDone)
+		{
+			TSharedPtr<IMediaTextureSample, ESPMode::ThreadSafe> Sample;
+#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 4
+			const IMediaSamples::EFetchBestSampleResult Result = Receiver.Player.FetchBestVideoSampleForTimeRange(TimeRange, Sample, false, false);
+#else
+			const IMediaSamples::EFetchBestSampleResult Result = Receiver.Player.FetchBestVideoSampleForTimeRange(TimeRange, Sample, false);
+#endif
+			if (Result == IMediaSamples::EFetchBestSampleResult::Ok && Sample)
+			{
+				const int64 Frame = static_cast<FSpout2MediaTextureSample*>(Sample.Get())->GetSenderFrame();
+				bFetchedInOrder &= Frame > LastFrame;
+				LastFrame = Frame;
+				NumFetched++;
+			}
+		}
+	});
+
+	TFuture<void> Peeker = Async(EAsyncExecution::Thread, [&]()
+	{
+		while (!bDone)
+		{
+			FMediaTimeStamp TimeStamp;
+			NumPeeked += Receiver.Player.PeekVideoSampleTime(TimeStamp) ? 1 : 0;
+		}
+	});
+
+	for (int32 Tick = 0; Tick < NumTicks; Tick++)
+	{
+		Receiver.Send();
+		FSpout2MediaPlayerTestAccess::TickReceiver(Receiver.Player);
+
+		if (Tick % 50 == 49)
+		{
+			Receiver.Player.FlushSamples();
+		}
+	}
+
+	bDone = true;
+	Fetcher.Wait();
+	Peeker.Wait();
+
+	AddInfo(FString::Printf(TEXT("%d ticks, %d samples fetched, %d peeks found a sample"), NumTicks, NumFetched, NumPeeked));
+
+	TestTrue(TEXT("Samples are fetched while another thread peeks"), NumFetched > 0);
+	TestTrue(TEXT("Fetched samples arrive in order, none twice"), bFetchedInOrder);
+	TestTrue(TEXT("No more samples than the pool holds are in use"),
+		FSpout2MediaPlayerTestAccess::GetNumPooledSamples(Receiver.Player) <= FSpout2MediaPlayerTestAccess::GetMaxPooledSamples());
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpout2MediaPlayerSteadyStateAllocationTest, "Spout2Media.Player.SteadyStateAllocations",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSpout2MediaPlayerSteadyStateAllocationTest::RunTest(const FString& Parameters)
+{
+	using namespace Spout2MediaPlayerTests;
+
+	constexpr int32 NumWarmUpTicks = 8;
+	constexpr int32 NumMeasuredTicks = 120;
+
+	FLoopbackReceiver Receiver;
+	if (!TestNotNull(TEXT("Loopback sender"), Receiver.Sender.get()))
+		return false;
+
+	// Creates the pooled samples and their textures, and sizes every container on the receive path
+	for (int32 Tick = 0; Tick < NumWarmUpTicks; Tick++)
+	{
+		Receiver.Send();
+		Receiver.TickAndFetch();
+	}
+
+	const int32 NumPooledSamples = FSpout2MediaPlayerTestAccess::GetNumPooledSamples(Receiver.Player);
+
+	FCountingMalloc& CountingMalloc = FCountingMalloc::Get();
+	CountingMalloc.Install();
+
+	int32 NumDelivered = 0;
+	for (int32 Tick = 0; Tick < NumMeasuredTicks; Tick++)
+	{
+		const uint64 Sent = Receiver.Send();
+
+		// Counted: the receiver context's render thread pass and the fetch, not the sender or the test
+		ENQUEUE_RENDER_COMMAND(Spout2MediaTestCountedTick)([&Receiver](FRHICommandListImmediate& RHICmdList)
+		{
+			{
+				FScopedAllocationCount Count;
+				FSpout2MediaPlayerTestAccess::TickReceiver_RenderThread(Receiver.Player, RHICmdList);
+			}
+
+			RHICmdList.ImmediateFlush(EImmediateFlushType::FlushRHIThread);
+			RHICmdList.BlockUntilGPUIdle();
+		});
+		FlushRenderingCommands();
+
+		TSharedPtr<IMediaTextureSample, ESPMode::ThreadSafe> Sample;
+		bool bFetched = false;
+		{
+			FScopedAllocationCount Count;
+			bFetched = Receiver.Player.FetchVideo(TRange<FTimespan>::All(), Sample);
+		}
+
+		if (bFetched && Sample && static_cast<FSpout2MediaTextureSample*>(Sample.Get())->GetSenderFrame() == static_cast<int64>(Sent))
+		{
+			NumDelivered++;
+		}
+	}
+
+	CountingMalloc.Uninstall();
+
+	const int32 NumAllocations = CountingMalloc.NumAllocations;
+	AddInfo(FString::Printf(TEXT("%d allocations in %d steady-state ticks, %d pooled samples"),
+		NumAllocations, NumMeasuredTicks, NumPooledSamples));
+
+	TestEqual(TEXT("Frames delivered"), NumDelivered, NumMeasuredTicks);
+	TestEqual(TEXT("Allocations in steady-state ticks"), NumAllocations, 0);
+	TestEqual(TEXT("Pooled samples after the steady-state ticks"),
+		FSpout2MediaPlayerTestAccess::GetNumPooledSamples(Receiver.Player), NumPooledSamples);
+
+	return true;
+}
+
+#endif
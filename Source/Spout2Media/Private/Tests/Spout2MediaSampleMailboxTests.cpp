@@ -0,0 +1,192 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Async/Async.h"
+#include "Misc/AutomationTest.h"
+
+#include "Spout2MediaSampleQueue.h"
+#include "Spout2MediaTextureSample.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpout2MediaSampleMailboxHandoffTest, "Spout2Media.SampleMailbox.Handoff",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSpout2MediaSampleMailboxHandoffTest::RunTest(const FString& Parameters)
+{
+	using FSamplePtr = FSpout2MediaSampleMailbox::FSamplePtr;
+
+	constexpr int32 NumSamples = 20000;
+
+	// Made up front, so the producer only posts
+	TArray<FSamplePtr> Samples;
+	Samples.Reserve(NumSamples);
+	for (int32 Index = 0; Index < NumSamples; Index++)
+	{
+		FSamplePtr& Sample = Samples.Add_GetRef(MakeShared<FSpout2MediaTextureSample, ESPMode::ThreadSafe>());
+		Sample->SetSenderFrame(Index + 1);
+	}
+
+	FSpout2MediaSampleMailbox Mailbox(8);
+	std::atomic<bool> bProducerDone{false};
+	int32 NumPosted = 0;
+	int32 NumDropped = 0;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	TFuture<void> Producer = Async(EAsyncExecution::Thread, [&]()
+	{
+		for (const FSamplePtr& Sample : Samples)
+		{
+			if (Mailbox.Post(Sample))
+			{
+				NumPosted++;
+			}
+			else
+			{
+				NumDropped++;
+			}
+		}
+		bProducerDone = true;
+	});
+
+	// Consumer, takes whatever arrived like PromoteCompletedSamples does
+	int32 NumTaken = 0;
+	int64 LastFrame = 0;
+	bool bInOrder = true;
+	for (;;)
+	{
+		const bool bDone = bProducerDone;
+
+		FSamplePtr Sample;
+		while (Mailbox.Take(Sample))
+		{
+			bInOrder &= Sample->GetSenderFrame() > LastFrame;
+			LastFrame = Sample->GetSenderFrame();
+			NumTaken++;
+		}
+
+		if (bDone)
+			break;
+	}
+
+	Producer.Wait();
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+	TestTrue(TEXT("Samples arrive in the order they were posted"), bInOrder);
+	TestEqual(TEXT("Every post is either taken or dropped"), NumPosted + NumDropped, NumSamples);
+	TestEqual(TEXT("Every posted sample is taken"), NumTaken, NumPosted);
+	TestEqual(TEXT("Newest sample dimension"), Mailbox.GetLatestDim(), FIntPoint(0, 0));
+
+	AddInfo(FString::Printf(TEXT("%d posts in %.2f ms, %.0f posts/s, %d dropped (%.1f%%)"),
+		NumSamples, Seconds * 1000.0, NumSamples / FMath::Max(Seconds, 1e-9), NumDropped, 100.0 * NumDropped / NumSamples));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpout2MediaSampleMailboxCapacityTest, "Spout2Media.SampleMailbox.Capacity",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSpout2MediaSampleMailboxCapacityTest::RunTest(const FString& Parameters)
+{
+	using FSamplePtr = FSpout2MediaSampleMailbox::FSamplePtr;
+
+	// The player sizes its pending samples and its pool from the capacity, not from the ring underneath
+	for (const uint32 Capacity : { 1u, 3u, 8u, 15u })
+	{
+		FSpout2MediaSampleMailbox Mailbox(Capacity);
+		const FSamplePtr Sample = MakeShared<FSpout2MediaTextureSample, ESPMode::ThreadSafe>();
+
+		uint32 NumPosted = 0;
+		while (NumPosted < 2 * Capacity + 2 && Mailbox.Post(Sample))
+		{
+			NumPosted++;
+		}
+		TestEqual(FString::Printf(TEXT("Capacity %u holds exactly that many samples"), Capacity), NumPosted, Capacity);
+
+		FSamplePtr Taken;
+		TestTrue(TEXT("Take frees a place"), Mailbox.Take(Taken));
+		TestTrue(TEXT("Post after take"), Mailbox.Post(Sample));
+		TestFalse(TEXT("Full again"), Mailbox.Post(Sample));
+
+		uint32 NumTaken = 0;
+		while (Mailbox.Take(Taken))
+		{
+			NumTaken++;
+		}
+		TestEqual(TEXT("Every held sample is taken"), NumTaken, Capacity);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpout2MediaSampleMailboxWakeLatencyTest, "Spout2Media.SampleMailbox.WakeLatency",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSpout2MediaSampleMailboxWakeLatencyTest::RunTest(const FString& Parameters)
+{
+	using FSamplePtr = FSpout2MediaSampleMailbox::FSamplePtr;
+
+	constexpr int32 NumWakes = 500;
+
+	FSpout2MediaSampleMailbox Mailbox(8);
+	const FSamplePtr Sample = MakeShared<FSpout2MediaTextureSample, ESPMode::ThreadSafe>();
+
+	// Measured like WaitForSync reports Sync Wake Latency, from the post to the waiter running again
+	TArray<double> LatenciesMs;
+	LatenciesMs.Reserve(NumWakes);
+	std::atomic<int32> NumWoken{0};
+	std::atomic<int32> NumTimeouts{0};
+
+	TFuture<void> Waiter = Async(EAsyncExecution::Thread, [&]()
+	{
+		while (NumWoken < NumWakes)
+		{
+			if (!Mailbox.WaitForPost(1000))
+			{
+				NumTimeouts++;
+				break;
+			}
+
+			LatenciesMs.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - Mailbox.GetLastPostCycles()));
+
+			FSamplePtr Taken;
+			while (Mailbox.Take(Taken))
+			{
+			}
+			NumWoken++;
+		}
+	});
+
+	for (int32 Index = 0; Index < NumWakes && NumTimeouts == 0; Index++)
+	{
+		// Gives the waiter time to block again, so every post wakes a sleeping thread
+		FPlatformProcess::SleepNoStats(0.001f);
+
+		const int32 Expected = Index + 1;
+		Mailbox.Post(Sample);
+		while (NumWoken < Expected && NumTimeouts == 0)
+		{
+			FPlatformProcess::YieldThread();
+		}
+	}
+
+	Waiter.Wait();
+
+	TestEqual(TEXT("Waits that timed out"), NumTimeouts.load(), 0);
+	TestEqual(TEXT("Wakes measured"), LatenciesMs.Num(), NumWakes);
+	if (LatenciesMs.Num() == 0)
+		return false;
+
+	LatenciesMs.Sort();
+	auto Percentile = [&LatenciesMs](double Fraction)
+	{
+		return LatenciesMs[FMath::Min(int32(Fraction * LatenciesMs.Num()), LatenciesMs.Num() - 1)];
+	};
+
+	AddInfo(FString::Printf(TEXT("Signal-to-wake latency over %d wakes: p50 %.3f ms, p99 %.3f ms, max %.3f ms"),
+		LatenciesMs.Num(), Percentile(0.5), Percentile(0.99), LatenciesMs.Last()));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,96 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "RenderingThread.h"
+
+#include "Spout2MediaTextureSample.h"
+#include "SpoutReceiverBackend.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpoutReceiverBackendSelectTest, "Spout2Media.ReceiverBackend.Select",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSpoutReceiverBackendSelectTest::RunTest(const FString& Parameters)
+{
+	using namespace SpoutReceiverBackend;
+
+	TestTrue(TEXT("D3D11 RHI uses D3D11"), Select(ERHIInterfaceType::D3D11, 0) == ESpoutReceiverBackend::D3D11);
+	TestTrue(TEXT("D3D11 RHI ignores the D3D11On12 preference"), Select(ERHIInterfaceType::D3D11, 1) == ESpoutReceiverBackend::D3D11);
+	TestTrue(TEXT("D3D11 RHI ignores the D3D12 preference"), Select(ERHIInterfaceType::D3D11, 3) == ESpoutReceiverBackend::D3D11);
+
+	// Spout's legacy share handles are only reliably opened through D3D11On12
+	TestTrue(TEXT("D3D12 RHI defaults to D3D11On12"), Select(ERHIInterfaceType::D3D12, 0) == ESpoutReceiverBackend::D3D11On12);
+	TestTrue(TEXT("D3D12 RHI with the D3D11On12 preference"), Select(ERHIInterfaceType::D3D12, 1) == ESpoutReceiverBackend::D3D11On12);
+	TestTrue(TEXT("D3D12 RHI with the D3D12 preference"), Select(ERHIInterfaceType::D3D12, 3) == ESpoutReceiverBackend::D3D12);
+
+	TestTrue(TEXT("Mock preference on D3D11"), Select(ERHIInterfaceType::D3D11, 2) == ESpoutReceiverBackend::Mock);
+	TestTrue(TEXT("Mock preference on D3D12"), Select(ERHIInterfaceType::D3D12, 2) == ESpoutReceiverBackend::Mock);
+	TestTrue(TEXT("Mock preference without a D3D RHI"), Select(ERHIInterfaceType::Vulkan, 2) == ESpoutReceiverBackend::Mock);
+
+	TestTrue(TEXT("No backend without a D3D RHI"), Select(ERHIInterfaceType::Vulkan, 0) == ESpoutReceiverBackend::None);
+	TestTrue(TEXT("No backend on the null RHI"), Select(ERHIInterfaceType::Null, 0) == ESpoutReceiverBackend::None);
+
+	TUniquePtr<ISpoutReceiverBackend> Backend = Create(ESpoutReceiverBackend::Mock, PF_B8G8R8A8);
+	TestTrue(TEXT("Create makes the mock backend"), Backend.IsValid() && Backend->GetType() == ESpoutReceiverBackend::Mock);
+	TestFalse(TEXT("Create makes nothing for None"), Create(ESpoutReceiverBackend::None, PF_B8G8R8A8).IsValid());
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpoutMockReceiverBackendLifecycleTest, "Spout2Media.ReceiverBackend.MockLifecycle",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSpoutMockReceiverBackendLifecycleTest::RunTest(const FString& Parameters)
+{
+	FSpoutMockReceiverBackend Backend;
+	FSpout2MediaTextureSample Sample;
+
+	const HANDLE FirstHandle = reinterpret_cast<HANDLE>(static_cast<UPTRINT>(0x100));
+	const HANDLE SecondHandle = reinterpret_cast<HANDLE>(static_cast<UPTRINT>(0x200));
+
+	// Copies are recorded on the render thread, like the receiver context does
+	auto CopyOnRenderThread = [&Backend, &Sample]()
+	{
+		bool bCopied = false;
+		ENQUEUE_RENDER_COMMAND(SpoutMockReceiverBackendCopy)([&Backend, &Sample, &bCopied](FRHICommandListImmediate& RHICmdList)
+		{
+			bCopied = Backend.CopyToSample(RHICmdList, Sample);
+		});
+		FlushRenderingCommands();
+		return bCopied;
+	};
+
+	TestFalse(TEXT("Nothing is open at first"), Backend.IsSharedTextureOpen());
+	TestFalse(TEXT("Nothing is copied before opening"), CopyOnRenderThread());
+	TestEqual(TEXT("Copies before opening"), Backend.NumCopies, 0);
+
+	TestFalse(TEXT("A null handle does not open"), Backend.OpenSharedTexture(nullptr));
+	TestEqual(TEXT("Opens of a null handle"), Backend.NumOpens, 0);
+
+	TestTrue(TEXT("First handle opens"), Backend.OpenSharedTexture(FirstHandle));
+	TestTrue(TEXT("Same handle stays open"), Backend.OpenSharedTexture(FirstHandle));
+	TestEqual(TEXT("Opens of the first handle"), Backend.NumOpens, 1);
+	TestEqual(TEXT("Closes while the first handle is open"), Backend.NumCloses, 0);
+
+	TestTrue(TEXT("Copy from the first handle"), CopyOnRenderThread());
+	TestTrue(TEXT("Second copy from the first handle"), CopyOnRenderThread());
+	TestEqual(TEXT("Copies from the first handle"), Backend.NumCopies, 2);
+
+	// A new handle means the sender recreated its texture, the old one is closed first
+	TestTrue(TEXT("Second handle opens"), Backend.OpenSharedTexture(SecondHandle));
+	TestEqual(TEXT("Opens after the handle changed"), Backend.NumOpens, 2);
+	TestEqual(TEXT("Closes after the handle changed"), Backend.NumCloses, 1);
+	TestTrue(TEXT("Second handle is open"), Backend.OpenHandle == SecondHandle);
+
+	Backend.CloseSharedTexture();
+	Backend.CloseSharedTexture();
+	TestFalse(TEXT("Closed"), Backend.IsSharedTextureOpen());
+	TestEqual(TEXT("Closing twice closes once"), Backend.NumCloses, 2);
+	TestFalse(TEXT("Nothing is copied once closed"), CopyOnRenderThread());
+	TestEqual(TEXT("Copies in total"), Backend.NumCopies, 2);
+
+	return true;
+}
+
+#endif
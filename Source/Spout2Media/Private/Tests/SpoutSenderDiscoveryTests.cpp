@@ -0,0 +1,181 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Async/Async.h"
+#include "HAL/Event.h"
+#include "Misc/AutomationTest.h"
+
+#include "Spout2MediaTransport.h"
+#include "SpoutSenderDirectoryMapping.h"
+#include "SpoutSenderDiscovery.h"
+
+#include <atomic>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SpoutSenderDiscoveryTests
+{
+	/** Shared texture sender in the sender directory, under a name no other test uses */
+	struct FDirectorySender
+	{
+		FString SenderName = FString::Printf(TEXT("Spout2MediaDiscoveryTest_%s"), *FGuid::NewGuid().ToString());
+		FSpoutSenderDirectoryEntry Entry;
+
+		void Register(uint32 Width)
+		{
+			SpoutSenderDirectory::FSenderInfo Info;
+			FCStringAnsi::Strncpy(Info.Name, TCHAR_TO_ANSI(*SenderName), SpoutSenderDirectory::MaxNameLength);
+			Info.Width = Width;
+			Info.Height = 16;
+			Info.Format = 87;
+			Info.ShareHandle = 0x1234;
+			Info.Transport = static_cast<uint32>(ESpout2MediaTransport::SharedTexture);
+			Entry.Register(Info);
+		}
+	};
+
+	bool WaitUntil(const std::atomic<bool>& bFlag, double TimeoutSeconds)
+	{
+		const double EndTime = FPlatformTime::Seconds() + TimeoutSeconds;
+		while (!bFlag && FPlatformTime::Seconds() < EndTime)
+		{
+			FPlatformProcess::SleepNoStats(0.001f);
+		}
+		return bFlag;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpoutSenderDiscoveryCallbackTest, "Spout2Media.Discovery.Callbacks",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSpoutSenderDiscoveryCallbackTest::RunTest(const FString& Parameters)
+{
+	using namespace SpoutSenderDiscoveryTests;
+
+	FSpoutSenderDiscovery Discovery;
+	FDirectorySender Sender;
+	FDirectorySender OtherSender;
+
+	FEvent* ReleaseCallback = FPlatformProcess::GetSynchEventFromPool(true);
+	std::atomic<bool> bInCallback{false};
+	std::atomic<int32> NumCalls{0};
+
+	// Blocks in the Added event until the test releases it
+	const uint32 Subscription = Discovery.Subscribe(Sender.SenderName, [&](ESpoutSenderEvent Event, const FSpoutSenderDescription& Description)
+	{
+		NumCalls++;
+		if (Event == ESpoutSenderEvent::Added)
+		{
+			bInCallback = true;
+			ReleaseCallback->Wait(FTimespan::FromSeconds(5.0));
+			bInCallback = false;
+		}
+	});
+
+	Sender.Register(16);
+	TestTrue(TEXT("The discovery thread calls back for a registered sender"), WaitUntil(bInCallback, 2.0));
+
+	// The discovery's lock is not held while the callback runs, other players can still subscribe
+	TFuture<uint32> OtherSubscribe = Async(EAsyncExecution::Thread, [&Discovery, &OtherSender]()
+	{
+		return Discovery.Subscribe(OtherSender.SenderName, [](ESpoutSenderEvent, const FSpoutSenderDescription&) {});
+	});
+	TestTrue(TEXT("Subscribe returns while another subscriber's callback runs"), OtherSubscribe.WaitFor(FTimespan::FromSeconds(2.0)));
+
+	// Unsubscribe waits for the call in progress
+	TFuture<void> Unsubscribe = Async(EAsyncExecution::Thread, [&Discovery, Subscription]()
+	{
+		Discovery.Unsubscribe(Subscription);
+	});
+	TestFalse(TEXT("Unsubscribe waits while the callback runs"), Unsubscribe.WaitFor(FTimespan::FromMilliseconds(100.0)));
+
+	ReleaseCallback->Trigger();
+	TestTrue(TEXT("Unsubscribe returns once the callback did"), Unsubscribe.WaitFor(FTimespan::FromSeconds(2.0)));
+	TestFalse(TEXT("The callback is not running after Unsubscribe"), bInCallback.load());
+
+	// Changes after Unsubscribe returned are not delivered anymore
+	const int32 NumCallsAfterUnsubscribe = NumCalls;
+	Sender.Register(32);
+	Sender.Entry.Unregister();
+	FPlatformProcess::SleepNoStats(0.2f);
+	TestEqual(TEXT("Calls after Unsubscribe"), NumCalls.load(), NumCallsAfterUnsubscribe);
+
+	if (OtherSubscribe.WaitFor(FTimespan::FromSeconds(2.0)))
+	{
+		Discovery.Unsubscribe(OtherSubscribe.Get());
+	}
+	Unsubscribe.Wait();
+
+	FPlatformProcess::ReturnSynchEventToPool(ReleaseCallback);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpoutSenderDiscoveryEventOrderTest, "Spout2Media.Discovery.EventOrder",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSpoutSenderDiscoveryEventOrderTest::RunTest(const FString& Parameters)
+{
+	using namespace SpoutSenderDiscoveryTests;
+
+	FSpoutSenderDiscovery Discovery;
+	FDirectorySender Sender;
+
+	std::atomic<bool> bFound{false};
+	const uint32 FirstSubscription = Discovery.Subscribe(Sender.SenderName, [&bFound](ESpoutSenderEvent Event, const FSpoutSenderDescription&)
+	{
+		bFound = bFound || Event == ESpoutSenderEvent::Added;
+	});
+
+	Sender.Register(16);
+	TestTrue(TEXT("The sender is found"), WaitUntil(bFound, 2.0));
+
+	// A later subscriber gets the sender that is already there from Subscribe itself, before any change
+	FCriticalSection EventsLock;
+	TArray<TPair<ESpoutSenderEvent, uint32>> Events;
+	const uint32 Subscription = Discovery.Subscribe(Sender.SenderName, [&](ESpoutSenderEvent Event, const FSpoutSenderDescription& Description)
+	{
+		FScopeLock Lock(&EventsLock);
+		Events.Add({ Event, Description.Width });
+	});
+
+	{
+		FScopeLock Lock(&EventsLock);
+		TestEqual(TEXT("Events delivered by Subscribe"), Events.Num(), 1);
+	}
+
+	Sender.Register(32);
+	FPlatformProcess::SleepNoStats(0.1f);
+	Sender.Entry.Unregister();
+
+	const double EndTime = FPlatformTime::Seconds() + 2.0;
+	while (FPlatformTime::Seconds() < EndTime)
+	{
+		{
+			FScopeLock Lock(&EventsLock);
+			if (Events.Num() > 0 && Events.Last().Key == ESpoutSenderEvent::Removed)
+				break;
+		}
+
+		FPlatformProcess::SleepNoStats(0.001f);
+	}
+
+	Discovery.Unsubscribe(Subscription);
+	Discovery.Unsubscribe(FirstSubscription);
+
+	const TArray<TPair<ESpoutSenderEvent, uint32>> Expected =
+	{
+		{ ESpoutSenderEvent::Added, 16 },
+		{ ESpoutSenderEvent::Resized, 32 },
+		{ ESpoutSenderEvent::Removed, 0 },
+	};
+
+	TestEqual(TEXT("Events"), Events.Num(), Expected.Num());
+	for (int32 Index = 0; Index < FMath::Min(Events.Num(), Expected.Num()); Index++)
+	{
+		TestTrue(FString::Printf(TEXT("Event %d"), Index), Events[Index].Key == Expected[Index].Key);
+		TestEqual(FString::Printf(TEXT("Width of event %d"), Index), Events[Index].Value, Expected[Index].Value);
+	}
+
+	return true;
+}
+
+#endif
@@ -6,6 +6,8 @@
 #include "Modules/ModuleManager.h"
 #include "IMediaPlayerFactory.h"
 
+class FSpoutSenderDiscovery;
+
 class FSpout2MediaModule
 	: public IModuleInterface
 	, public IMediaPlayerFactory
@@ -13,12 +15,20 @@ class FSpout2MediaModule
 	TArray<FString> SupportedPlatforms;
 	TArray<FString> SupportedUriSchemes;
 
+	FDelegateHandle EndFrameRTHandle;
+
+	// Watches senders for every player, runs while the module is loaded
+	TSharedPtr<FSpoutSenderDiscovery, ESPMode::ThreadSafe> SenderDiscovery;
+
 public:
 
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
 
+	// Sender discovery service of the loaded module, nullptr when it is not loaded
+	static FSpoutSenderDiscovery* GetSenderDiscovery();
+
 	/** IMediaPlayerFactory implementation */
 	virtual bool CanPlayUrl(const FString& Url, const IMediaOptions* /*Options*/, TArray<FText>* /*OutWarnings*/,
 							TArray<FText>* OutErrors) const override;
@@ -9,6 +9,8 @@
 #include "Spout2MediaCapture.generated.h"
 
 class FSpoutFrameSyncHelper;
+class FSpoutFrameSyncChannel;
+class FSpoutSenderDirectoryEntry;
 
 UCLASS(BlueprintType)
 class SPOUT2MEDIA_API USpout2MediaCapture
@@ -17,12 +19,17 @@ class SPOUT2MEDIA_API USpout2MediaCapture
 	GENERATED_UCLASS_BODY()
 
 	struct FSpoutSenderContext;
-	TSharedPtr<FSpoutSenderContext> Context;
+	TSharedPtr<FSpoutSenderContext, ESPMode::ThreadSafe> Context;
+
+	// Sender of a CPU frame transport, used instead of Context when the output asks for one
+	struct FSpoutTransportSenderContext;
+	TSharedPtr<FSpoutTransportSenderContext, ESPMode::ThreadSafe> TransportContext;
 
 public:
 	virtual bool HasFinishedProcessing() const override;
 	
 	// Frame synchronization controls
+	// Rate frames are sent at. Values <= 0 are ignored with a warning, the previous rate stays.
 	UFUNCTION(BlueprintCallable, Category = "Spout2 Media|Synchronization")
 	void SetFrameRate(int32 FramesPerSecond);
 	
@@ -51,6 +58,8 @@ protected:
 
 	virtual bool ShouldCaptureRHIResource() const override { return true; }
 	virtual void OnRHIResourceCaptured_RenderingThread(const FCaptureBaseData& InBaseData, TSharedPtr<FMediaCaptureUserData, ESPMode::ThreadSafe> InUserData, FTextureRHIRef InTexture) override;
+	virtual void OnCustomCapture_RenderingThread(FRDGBuilder& GraphBuilder, const FCaptureBaseData& InBaseData, TSharedPtr<FMediaCaptureUserData, ESPMode::ThreadSafe> InUserData,
+		FRDGTextureRef InSourceTexture, FRDGTextureRef OutputTexture, const FRHICopyTextureInfo& CopyInfo, FVector2D CropU, FVector2D CropV) override;
 
 private:
 	// Store the output frame rate from Spout2MediaOutput
@@ -59,8 +68,33 @@ private:
 	// Flag to indicate if render thread sync should be used
 	bool bLinkToRenderThread;
 	
+	// Whether sends are limited to OutputFrameRate, from USpout2MediaOutput::bEnableFrameRateControl
+	bool bFrameRateControl = true;
+	
 	// Frame sync helper
 	TSharedPtr<FSpoutFrameSyncHelper> FrameSyncHelper;
+	
+	// Resolved from the output when the capture starts, so captured frames do no string work
+	FString ModifiedSenderName;
+	TSharedPtr<FSpoutFrameSyncChannel, ESPMode::ThreadSafe> FrameSyncChannel;
+	
+	// Whether the output asked for the capture to render into the shared texture
+	bool bZeroCopy = false;
+	
+	// Shared textures the sender rotates through, see USpout2MediaOutput::NumSharedTextures
+	int32 NumSharedTextures = 1;
+	
+	// How frames reach receivers, and the sender name without FPS information transport senders go by
+	ESpout2MediaTransport Transport = ESpout2MediaTransport::SharedTexture;
+	FString BaseSenderName;
+	
+	// The sender's entry in the sender directory, registered while capturing
+	TSharedPtr<FSpoutSenderDirectoryEntry, ESPMode::ThreadSafe> DirectoryEntry;
+	void RegisterSender(uint32 Width, uint32 Height, uint32 Format, uint32 ShareHandle);
+	
+	// Creates the sender context again when the captured size or format changed
+	void UpdateContext(uint32 Width, uint32 Height, EPixelFormat PixelFormat, FTextureRHIRef InTexture, bool bInZeroCopy);
+	void UpdateTransportContext(uint32 Width, uint32 Height, EPixelFormat PixelFormat);
 
 	bool InitSpout(USpout2MediaOutput* Output);
 	bool DisposeSpout();
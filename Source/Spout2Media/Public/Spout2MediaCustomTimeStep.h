@@ -9,13 +9,49 @@
 #include "Spout2MediaPlayer.h"
 #include "Spout2MediaCustomTimeStep.generated.h"
 
+class FSpoutClockRecovery;
+class spoutFrameCount;
+
 UCLASS(Blueprintable)
 class SPOUT2MEDIA_API USpout2MediaCustomTimeStep : public UGenlockedFixedRateCustomTimeStep
 {
 	GENERATED_UCLASS_BODY()
 
+	// Resolved from MediaPlayer once, and the player again only when it stopped playing
+	UPROPERTY(Transient)
+	UMediaPlayer* CachedMediaPlayer = nullptr;
 	TSharedPtr<FSpout2MediaPlayer, ESPMode::ThreadSafe> SpoutMediaPlayer;
 	
+	// Sender clock tracked in clock recovery mode, recreated when the player's sender changes
+	TSharedPtr<FSpoutClockRecovery> ClockRecovery;
+	FName ClockRecoveryName;
+	
+	// Sender frame counter read after each sync, recreated when the player's sender changes
+	TSharedPtr<spoutFrameCount> SenderFrameCount;
+	FName SenderFrameCountName;
+	
+	// Sender frames between the last two engine frames, 0 when both ticked on the same sender frame
+	uint32 LastSyncCountDelta = 1;
+	bool bLastSyncDataValid = false;
+	
+	// Sender frame the last engine frame ticked on, 0 before the first one
+	int64 LastSyncSenderFrame = 0;
+	
+	// Predicted sender frame time the last engine frame ticked on, in FPlatformTime::Seconds
+	double LastTickTime = 0.0;
+	
+	// Finds the Spout player behind MediaPlayer, false when it is not playing
+	bool ResolvePlayer();
+	
+	// Ticks on the next predicted sender frame, false while the clock is not locked
+	bool TickInPhase(int64& OutPredictedSenderFrame);
+	
+	// Sender frame counter now, 0 when the sender does not count frames
+	int64 ReadSenderFrame();
+	
+	// Updates the sync count delta from the sender's frame counter, or from PredictedSenderFrame when it keeps none
+	void UpdateSyncCount(int64 PredictedSenderFrame, bool bSynced);
+	
 public:
 	//~ UFixedFrameRateCustomTimeStep interface
 	virtual bool Initialize(UEngine* InEngine) override;
@@ -29,8 +65,21 @@ public:
 	virtual bool IsLastSyncDataValid() const override;
 	virtual bool WaitForSync() override;
 
+	// Drift of the sender's clock against its nominal frame rate, estimated in clock recovery mode
+	UFUNCTION(BlueprintCallable, Category="Spout Media")
+	float GetEstimatedDriftPpm() const;
+
 public:
 	// Media player to synchronize with
 	UPROPERTY(EditAnywhere, Category="Spout Media")
 	TSoftObjectPtr<UMediaPlayer> MediaPlayer;
+	
+	// Recover the sender's frame clock on a background thread and tick in phase with its predicted frames
+	// instead of waiting for each one. Waits for frames as usual until the recovered clock is locked.
+	UPROPERTY(EditAnywhere, Category="Spout Media|Clock Recovery")
+	bool bClockRecovery = false;
+	
+	// Loop bandwidth of the clock recovery. Lower filters more arrival jitter but follows rate changes slower.
+	UPROPERTY(EditAnywhere, Category="Spout Media|Clock Recovery", meta=(EditCondition="bClockRecovery", ClampMin="0.05", ClampMax="10.0", Units="Hz"))
+	float ClockRecoveryBandwidth = 1.0f;
 };
\ No newline at end of file
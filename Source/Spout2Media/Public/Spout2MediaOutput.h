@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "MediaOutput.h"
 #include "MediaIOCoreDefinitions.h"
+#include "Spout2MediaTransport.h"
 
 #include "Spout2MediaOutput.generated.h"
 
@@ -25,6 +26,10 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media")
 	FFrameRate OutputFrameRate = FFrameRate(60, 1);
 	
+	// How frames reach receivers, receivers have to use the same transport
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media")
+	ESpout2MediaTransport Transport = ESpout2MediaTransport::SharedTexture;
+	
 	// Whether to link Spout frame syncs directly to the render thread
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media|Synchronization")
 	bool bLinkToRenderThread = true;
@@ -33,6 +38,17 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media|Synchronization")
 	bool bEnableFrameRateControl = true;
 	
+	// Write the capture straight into the Spout shared texture instead of copying the captured frame into it.
+	// The sender then shares the capture source's pixel format. D3D11 RHI only, other RHIs keep copying.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media|Performance")
+	bool bZeroCopy = false;
+	
+	// Shared textures the sender rotates through. With more than one, receivers of this plugin always read
+	// a complete frame while the next one is written. Other Spout receivers keep working but reopen the
+	// texture on each frame. 1 sends the usual single texture.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media|Performance", meta = (ClampMin = "1", ClampMax = "4"))
+	int32 NumSharedTextures = 1;
+	
 	// Gets sender name with embedded frame rate information
 	UFUNCTION(BlueprintCallable, Category = "Spout2 Media")
 	FString GetModifiedSenderName() const;
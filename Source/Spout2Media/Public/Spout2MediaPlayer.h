@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "MediaIOCorePlayerBase.h"
 
+class FRHICommandListImmediate;
+
 class SPOUT2MEDIA_API FSpout2MediaPlayer
 	: public IMediaPlayer
 	, protected IMediaCache
@@ -14,7 +16,7 @@ class SPOUT2MEDIA_API FSpout2MediaPlayer
 	, public IMediaTracks
 {
 	struct FSpoutReceiverContext;
-	TSharedPtr<FSpoutReceiverContext> Context;
+	TSharedPtr<FSpoutReceiverContext, ESPMode::ThreadSafe> Context;
 
 public:
 	
@@ -46,11 +48,14 @@ public:
 	// Returns whether the hardware interface is ready for synchronization
 	bool IsHardwareReady() const;
 	
-	// Wait for the next frame to synchronize
+	// Wait for the next frame to synchronize, at most the source's FrameSyncTimeoutMs
 	void WaitForSync();
 	
+	// Wait for the next frame sync event, at most the source's FrameSyncTimeoutMs
+	bool WaitForFrameSync();
+	
 	// Wait for the next frame sync event with timeout
-	bool WaitForFrameSync(uint32 TimeoutMs = 100);
+	bool WaitForFrameSync(uint32 TimeoutMs);
 	
 	// Enable/disable frame sync
 	void SetUseFrameSync(bool bEnable);
@@ -65,7 +70,13 @@ public:
 	void SetLinkRenderingToFrameSync(bool bEnable) { bLinkRenderingToFrameSync = bEnable; }
 	
 	// Get the source name without FPS information
-	FString GetSourceName() const;
+	const FString& GetSourceName() const;
+	
+	// Get the Spout sender name as subscribed, with FPS information
+	FString GetSenderName() const { return SubscribeName.ToString(); }
+	
+	// Same as GetSenderName without building a string, for callers checking every frame whether it changed
+	FName GetSubscribeName() const { return SubscribeName; }
 	
 protected:
 	
@@ -78,7 +89,8 @@ protected:
 	virtual EMediaStatus GetStatus() const override { return EMediaStatus::None; }
 	virtual TRangeSet<float> GetSupportedRates(EMediaRateThinning Thinning) const override
 		{ return TRangeSet<float>(); }
-	virtual FTimespan GetTime() const override { return 0; }
+	// Current time on the clock received samples are stamped on, see Spout2MediaClock
+	virtual FTimespan GetTime() const override;
 	virtual bool IsLooping() const override { return false; }
 	virtual bool Seek(const FTimespan& Time) override { return false; }
 	virtual bool SetLooping(bool Looping) override { return false; }
@@ -126,11 +138,33 @@ private:
 	FName SubscribeName = "";
 	bool bSRGB = true;
 	
-	TSharedPtr<IMediaTextureSample, ESPMode::ThreadSafe> TextureSample;
-	
-	// Frame timestamp tracking for synchronization
-	int64_t FrameTimeStamp = 0;
-	int64_t LastFrameTimeStamp = 0;
+	// Sample ownership: the render thread records a sample's copy and posts it to SampleMailbox.
+	// The fetching side takes them from there and owns PendingSamples and SampleQueue. The media framework
+	// fetches on the render thread but peeks and flushes on the game thread, so FetchVideo,
+	// FetchBestVideoSampleForTimeRange, PeekVideoSampleTime and FlushSamples hold SamplesLock, which keeps
+	// the mailbox to one consumer at a time.
+	TSharedPtr<class FSpout2MediaSampleMailbox, ESPMode::ThreadSafe> SampleMailbox;
+	FCriticalSection SamplesLock;
+	
+	// Samples whose GPU copy is still in flight, oldest first. Holds at most MaxPendingSamples plus
+	// one drained mailbox inline, so it never allocates. The mailbox holds at most SampleMailboxCapacity.
+	static constexpr int32 MaxPendingSamples = 4;
+	static constexpr int32 SampleMailboxCapacity = 8;
+	TArray<TSharedPtr<class FSpout2MediaTextureSample, ESPMode::ThreadSafe>, TInlineAllocator<MaxPendingSamples + SampleMailboxCapacity>> PendingSamples;
+	
+	// Timestamped samples whose GPU copy completed, picked according to the source's buffer policy
+	TSharedPtr<class FSpout2MediaSampleQueue, ESPMode::ThreadSafe> SampleQueue;
+	
+	// Recycled receive samples, acquired on the render thread. Holds every sample the player can have in
+	// flight at once: the mailbox, the pending copies, the deepest sample queue (BufferDepth is at most 16),
+	// the samples a sync group holds back for the other members and a few the media texture still holds.
+	// Frames beyond that are dropped.
+	static constexpr int32 MaxSyncGroupSamples = 8;
+	static constexpr int32 MaxPooledSamples = SampleMailboxCapacity + MaxPendingSamples + 16 + MaxSyncGroupSamples + 4;
+	TSharedPtr<class FSpout2MediaTextureSamplePool, ESPMode::ThreadSafe> SamplePool;
+	
+	// Longest WaitForSync blocks for a frame
+	uint32 FrameSyncTimeoutMs = 100;
 	
 	// Current frame rate
 	FFrameRate FrameRate{60, 1};
@@ -140,9 +174,33 @@ private:
 	bool bLinkRenderingToFrameSync;
 	TSharedPtr<class FSpoutFrameSyncHelper> FrameSyncHelper;
 	
+	// Name of the sender's sync event, the subscribed name without FPS information, set in Open
+	FString SyncSourceName;
+	
+	// Sync group of the source, completed samples go through it before reaching SampleQueue
+	TSharedPtr<class FSpout2MediaSyncGroupState, ESPMode::ThreadSafe> SyncGroup;
+	int32 SyncGroupMemberId = INDEX_NONE;
+	
+	void LeaveSyncGroup();
+	
+	// Unregisters the receiver context from the render thread and drops it
+	void CloseContext();
+	
 	// Helper method to parse frame rate information from sender name
 	void ParseFrameRateFromSenderName(const FString& SenderName);
 	
+	// Takes posted samples and moves those whose copy completed to SampleQueue, through the sync group
+	// when there is one. Called with SamplesLock held.
+	void PromoteCompletedSamples();
+	
+	// Shared implementation of the FetchBestVideoSampleForTimeRange overloads
+	EFetchBestSampleResult FetchBestVideoSample(const TRange<FMediaTimeStamp>& TimeRange, TSharedPtr<IMediaTextureSample, ESPMode::ThreadSafe>& OutSample);
+	
+	// Runs one receiver context tick right away, on the render thread. The context ticks itself once per
+	// render thread frame; the automation tests drive it with this to control when frames arrive.
+	friend struct FSpout2MediaPlayerTestAccess;
+	void TickReceiver_RenderThread(FRHICommandListImmediate& RHICmdList);
+	
 	// Delegate handle for render thread synchronization
 	FDelegateHandle PreRenderDelegateHandle;
 };
\ No newline at end of file
@@ -4,9 +4,19 @@
 
 #include "CoreMinimal.h"
 #include "BaseMediaSource.h"
+#include "Spout2MediaTransport.h"
 
 #include "Spout2MediaSource.generated.h"
 
+UENUM(BlueprintType)
+enum class ESpout2MediaSampleBufferPolicy : uint8
+{
+	// Present the newest received frame
+	NewestOnly,
+	// Present frames a fixed number of frames behind the newest received one
+	FixedDelay,
+};
+
 UCLASS(BlueprintType, Blueprintable, meta=(DisplayName="Spout2 Media Source"), HideCategories=("Platforms"))
 class SPOUT2MEDIA_API USpout2MediaSource
 	: public UBaseMediaSource
@@ -22,17 +32,37 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media")
 	FFrameRate TargetFrameRate = FFrameRate(60, 1);
 	
+	// How frames arrive from the sender, has to match the sender's Spout2 Media Output
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media")
+	ESpout2MediaTransport Transport = ESpout2MediaTransport::SharedTexture;
+	
 	// Whether to use frame synchronization for precise frame timing
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media|Synchronization")
 	bool bUseFrameSync = false;
 	
-	// Maximum time to wait for frame sync in milliseconds (0 = don't wait)
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media|Synchronization", meta=(EditCondition="bUseFrameSync", ClampMin="0", ClampMax="1000"))
+	// Maximum time to wait for the next frame in milliseconds, with or without frame sync (0 = don't wait)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media|Synchronization", meta=(ClampMin="0", ClampMax="1000"))
 	int32 FrameSyncTimeoutMs = 100;
 	
 	// Whether to link the engine's rendering to the Spout frame sync
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media|Synchronization")
 	bool bLinkRenderingToFrameSync = false;
+	
+	// Sources sharing a sync group present frames from their senders together, see USpout2MediaSyncGroup
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media|Synchronization")
+	class USpout2MediaSyncGroup* SyncGroup = nullptr;
+	
+	// How received frames are picked for presentation
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media|Buffering")
+	ESpout2MediaSampleBufferPolicy BufferPolicy = ESpout2MediaSampleBufferPolicy::NewestOnly;
+	
+	// Number of received frames kept for the media framework to pick from
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media|Buffering", meta=(ClampMin="1", ClampMax="16"))
+	int32 BufferDepth = 2;
+	
+	// Frames of delay behind the newest received frame
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media|Buffering", meta=(EditCondition="BufferPolicy == ESpout2MediaSampleBufferPolicy::FixedDelay", ClampMin="0", ClampMax="15"))
+	int32 DelayFrames = 1;
 
 	virtual bool Validate() const override { return true; }
 	virtual FString GetUrl() const override;
@@ -0,0 +1,48 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+
+#include "Spout2MediaSyncGroup.generated.h"
+
+class FSpout2MediaSyncGroupState;
+
+UENUM(BlueprintType)
+enum class ESpout2MediaSyncGroupAlignment : uint8
+{
+	// Present frames with the same sender frame number, for senders counting frames in lockstep
+	FrameNumber,
+	// Present frames received within ArrivalToleranceMs of each other
+	ArrivalTime,
+};
+
+/**
+ * Spout2 media sources that join the same sync group present their frames together: a set of frames is
+ * released to the members' players only once every member received a frame for it.
+ */
+UCLASS(BlueprintType, meta=(DisplayName="Spout2 Media Sync Group"))
+class SPOUT2MEDIA_API USpout2MediaSyncGroup
+	: public UObject
+{
+	GENERATED_UCLASS_BODY()
+public:
+	// What makes frames of different members belong together
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media|Synchronization")
+	ESpout2MediaSyncGroupAlignment Alignment = ESpout2MediaSyncGroupAlignment::FrameNumber;
+	
+	// Largest difference between the arrival times of frames presented together
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media|Synchronization", meta=(EditCondition="Alignment == ESpout2MediaSyncGroupAlignment::ArrivalTime", ClampMin="0.1", ClampMax="100.0", Units="ms"))
+	float ArrivalToleranceMs = 8.0f;
+	
+	// Members without a new frame for this long no longer hold the others back, until they receive again
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Spout2 Media|Synchronization", meta=(ClampMin="1", ClampMax="1000"))
+	int32 TimeoutMs = 100;
+	
+	// Shared with the players of the member sources, created on first use and updated with the settings above
+	TSharedRef<FSpout2MediaSyncGroupState, ESPMode::ThreadSafe> GetState();
+
+private:
+	TSharedPtr<FSpout2MediaSyncGroupState, ESPMode::ThreadSafe> State;
+};
@@ -0,0 +1,19 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Spout2MediaTransport.generated.h"
+
+UENUM(BlueprintType)
+enum class ESpout2MediaTransport : uint8
+{
+	// D3D11 shared textures found through the Spout sender list, the usual Spout way
+	SharedTexture,
+	// Frames read back to the CPU and passed through a shared memory ring, for machines without GPU sharing.
+	// Only receivers of this plugin see these senders.
+	SharedMemory,
+	// Frames handed from a capture to players of the same process without copying, e.g. for benchmarks
+	Loopback,
+};
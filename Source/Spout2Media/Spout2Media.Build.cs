@@ -87,6 +87,7 @@ public class Spout2Media : ModuleRules
 				"Slate",
 				"SlateCore",
 				"RenderCore",
+				"Renderer",
 				"MediaUtils",
 				"RHI",
 				"Projects",
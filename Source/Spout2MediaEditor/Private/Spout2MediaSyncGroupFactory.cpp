@@ -0,0 +1,41 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Spout2MediaSyncGroupFactory.h"
+#include <AssetTypeCategories.h>
+
+#include "Spout2Media/Public/Spout2MediaSyncGroup.h"
+
+#define LOCTEXT_NAMESPACE "Spout2MediaSyncGroupFactory"
+
+USpout2MediaSyncGroupFactory::USpout2MediaSyncGroupFactory(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->bCreateNew = true;
+	this->bEditAfterNew = true;
+
+	this->SupportedClass = USpout2MediaSyncGroup::StaticClass();
+}
+
+FText USpout2MediaSyncGroupFactory::GetDisplayName() const
+{
+	return LOCTEXT("Spout2MediaSyncGroupFactoryDisplayName", "Spout2 Media Sync Group");
+}
+
+uint32 USpout2MediaSyncGroupFactory::GetMenuCategories() const
+{
+	return EAssetTypeCategories::Media;
+}
+
+bool USpout2MediaSyncGroupFactory::ShouldShowInNewMenu() const
+{
+	return Super::ShouldShowInNewMenu();
+}
+
+UObject* USpout2MediaSyncGroupFactory::FactoryCreateNew(UClass* InClass, UObject* InParent, FName InName,
+	EObjectFlags Flags, UObject* Context, FFeedbackContext* Warn)
+{
+	return NewObject<USpout2MediaSyncGroup>(InParent, InClass, InName, Flags | RF_Transactional);
+}
+
+#undef LOCTEXT_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,235 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+// Stress test of SpoutBufferIndex. Standard C++ only and outside the module, so UnrealBuildTool does not
+// compile it; build and run it headless on any platform:
+//   g++ -std=c++17 -O2 -pthread -I../Spout2Media/Private SpoutBufferIndexStressTest.cpp -o SpoutBufferIndexStressTest
+//   ./SpoutBufferIndexStressTest [NumFrames] [NumReaders]
+//
+// One writer thread renders frames into the buffers, readers copy the latest one like receivers do.
+// Every buffer is stamped with the sequence number it is published under. The test fails when a reader
+// holds a buffer the writer is writing, reads a torn or stale frame, or sequence numbers go backwards.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "SpoutBufferIndex.h"
+
+namespace
+{
+	constexpr uint32_t NumBuffers = 3;
+	constexpr size_t NumWords = 1024;
+
+	struct FBuffer
+	{
+		// Stands in for the shared texture, every word holds the frame's sequence number
+		std::array<std::atomic<uint64_t>, NumWords> Words{};
+
+		// Set by the test around the writer's and readers' accesses, checked against each other
+		std::atomic<uint32_t> Writing{0};
+		std::atomic<uint32_t> Reading{0};
+	};
+
+	std::array<FBuffer, NumBuffers> Buffers;
+	std::atomic<bool> bWriterDone{false};
+	std::atomic<uint64_t> NumViolations{0};
+
+	void Fail(const char* What, uint32_t Index, uint64_t Value)
+	{
+		if (NumViolations.fetch_add(1) < 10)
+		{
+			std::fprintf(stderr, "FAIL: %s (buffer %u, value %llu)\n", What, Index, static_cast<unsigned long long>(Value));
+		}
+	}
+
+	// Makes the accesses take a while, like a GPU copy would
+	void Spin(uint32_t Iterations)
+	{
+		for (volatile uint32_t Index = 0; Index < Iterations; Index++)
+		{
+		}
+	}
+
+	struct FWriterStats
+	{
+		uint64_t NumPublished = 0;
+		uint64_t NumAborted = 0;
+		uint64_t NumStalls = 0;
+	};
+
+	void RunWriter(SpoutBufferIndex::FLayout& Layout, uint64_t NumFrames, FWriterStats& Stats)
+	{
+		SpoutBufferIndex::FWriter Writer(Layout);
+		uint64_t Sequence = 0;
+
+		while (Stats.NumPublished < NumFrames)
+		{
+			const uint32_t Index = Writer.BeginWrite();
+			if (Index == SpoutBufferIndex::NoBuffer)
+			{
+				Stats.NumStalls++;
+				std::this_thread::yield();
+				continue;
+			}
+
+			FBuffer& Buffer = Buffers[Index];
+			Buffer.Writing.store(1);
+			if (Buffer.Reading.load() != 0)
+			{
+				Fail("writer picked a buffer a reader holds", Index, Sequence + 1);
+			}
+
+			// Every 16th frame is given back unpublished, with contents no reader may ever see
+			const bool bAbort = (Stats.NumPublished + Stats.NumAborted) % 16 == 15;
+			const uint64_t Value = bAbort ? ~0ull : Sequence + 1;
+			for (std::atomic<uint64_t>& Word : Buffer.Words)
+			{
+				Word.store(Value, std::memory_order_relaxed);
+			}
+			Spin(200);
+
+			Buffer.Writing.store(0);
+
+			if (bAbort)
+			{
+				Writer.AbortWrite(Index);
+				Stats.NumAborted++;
+				continue;
+			}
+
+			Sequence = Writer.EndWrite(Index);
+			if (Sequence != Value)
+			{
+				Fail("published sequence does not match the frame", Index, Sequence);
+			}
+			Stats.NumPublished++;
+
+			// Lets readers in between frames even on a single core, preemption covers the rest
+			std::this_thread::yield();
+		}
+
+		bWriterDone.store(true);
+	}
+
+	struct FReaderStats
+	{
+		uint64_t NumReads = 0;
+		uint64_t NumSkipped = 0;
+	};
+
+	void RunReader(SpoutBufferIndex::FLayout& Layout, FReaderStats& Stats)
+	{
+		SpoutBufferIndex::FReader Reader(Layout);
+		uint64_t LastSequence = 0;
+
+		while (!bWriterDone.load())
+		{
+			uint64_t Sequence = 0;
+			const uint32_t Index = Reader.BeginRead(LastSequence, Sequence);
+			if (Index == SpoutBufferIndex::NoBuffer)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			FBuffer& Buffer = Buffers[Index];
+			Buffer.Reading.fetch_add(1);
+			if (Buffer.Writing.load() != 0)
+			{
+				Fail("reader got a buffer the writer is writing", Index, Sequence);
+			}
+
+			if (Sequence <= LastSequence)
+			{
+				Fail("sequence went backwards", Index, Sequence);
+			}
+
+			for (const std::atomic<uint64_t>& Word : Buffer.Words)
+			{
+				const uint64_t Value = Word.load(std::memory_order_relaxed);
+				if (Value != Sequence)
+				{
+					Fail("torn or stale frame", Index, Value);
+					break;
+				}
+			}
+			Spin(400);
+
+			// Now and then a copy takes longer than a frame, the writer has to work around the held buffer
+			if (Stats.NumReads % 8 == 7)
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+			}
+
+			if (Buffer.Writing.load() != 0)
+			{
+				Fail("writer started on a buffer while it was read", Index, Sequence);
+			}
+
+			Buffer.Reading.fetch_sub(1);
+			Reader.EndRead(Index);
+
+			Stats.NumSkipped += Sequence - LastSequence - 1;
+			Stats.NumReads++;
+			LastSequence = Sequence;
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const uint64_t NumFrames = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+	const int NumReaders = argc > 2 ? std::atoi(argv[2]) : 3;
+
+	SpoutBufferIndex::FLayout Layout;
+	SpoutBufferIndex::Initialize(Layout, NumBuffers);
+	SpoutBufferIndex::Publish(Layout);
+
+	const auto Start = std::chrono::steady_clock::now();
+
+	FWriterStats WriterStats;
+	std::vector<FReaderStats> ReaderStats(NumReaders);
+	std::vector<std::thread> Threads;
+
+	for (int Reader = 0; Reader < NumReaders; Reader++)
+	{
+		Threads.emplace_back(RunReader, std::ref(Layout), std::ref(ReaderStats[Reader]));
+	}
+	Threads.emplace_back(RunWriter, std::ref(Layout), NumFrames, std::ref(WriterStats));
+
+	for (std::thread& Thread : Threads)
+	{
+		Thread.join();
+	}
+
+	const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+	std::printf("%d readers, %u buffers, %.2f s\n", NumReaders, NumBuffers, Seconds);
+	std::printf("writer: %llu published, %llu aborted, %llu stalls with every buffer in use\n",
+		static_cast<unsigned long long>(WriterStats.NumPublished),
+		static_cast<unsigned long long>(WriterStats.NumAborted),
+		static_cast<unsigned long long>(WriterStats.NumStalls));
+
+	for (int Reader = 0; Reader < NumReaders; Reader++)
+	{
+		std::printf("reader %d: %llu frames read, %llu skipped\n", Reader,
+			static_cast<unsigned long long>(ReaderStats[Reader].NumReads),
+			static_cast<unsigned long long>(ReaderStats[Reader].NumSkipped));
+	}
+
+	for (uint32_t Index = 0; Index < NumBuffers; Index++)
+	{
+		if (Layout.Readers[Index].load() != 0)
+		{
+			Fail("reader count left on a buffer", Index, Layout.Readers[Index].load());
+		}
+	}
+
+	const uint64_t Violations = NumViolations.load();
+	std::printf("%s: %llu violations\n", Violations == 0 ? "PASS" : "FAIL", static_cast<unsigned long long>(Violations));
+	return Violations == 0 ? 0 : 1;
+}
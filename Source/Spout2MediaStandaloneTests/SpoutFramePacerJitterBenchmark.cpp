@@ -0,0 +1,117 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+// Jitter distribution of FSpoutFramePacer. Standard C++ only and outside the module, so UnrealBuildTool does
+// not compile it; build and run it headless on any platform:
+//   g++ -std=c++17 -O2 -pthread -I../Spout2Media/Private SpoutFramePacerJitterBenchmark.cpp -o SpoutFramePacerJitterBenchmark
+//   ./SpoutFramePacerJitterBenchmark [Seconds]
+//
+// Paces a thread at several rates, once with WaitForNextFrame as the send thread does and once polling
+// IsFrameDue the way the render thread does, and prints percentiles of how late each frame was against its
+// deadline. The pure sleep run (spin threshold 0) shows what the spinning buys on this machine.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "SpoutFramePacer.h"
+
+namespace
+{
+	struct FRun
+	{
+		const char* Name;
+		int64_t Numerator;
+		int64_t Denominator;
+		std::chrono::nanoseconds SpinThreshold;
+		bool bPoll;
+	};
+
+	double Percentile(const std::vector<double>& Sorted, double Fraction)
+	{
+		if (Sorted.empty())
+			return 0.0;
+
+		const size_t Index = std::min(Sorted.size() - 1, static_cast<size_t>(Fraction * (Sorted.size() - 1) + 0.5));
+		return Sorted[Index];
+	}
+
+	void Measure(const FRun& Run, double Seconds)
+	{
+		FSpoutFramePacer Pacer;
+		Pacer.SpinThreshold = Run.SpinThreshold;
+		Pacer.SetFrameRate(Run.Numerator, Run.Denominator);
+
+		const int64_t NumFrames = static_cast<int64_t>(Seconds * Run.Numerator / Run.Denominator);
+
+		std::vector<double> JitterUs;
+		JitterUs.reserve(NumFrames);
+
+		// The first frame starts the schedule and has no deadline to be late for
+		Pacer.WaitForNextFrame();
+		Pacer.ResetJitterStats();
+
+		const auto Start = FSpoutFramePacer::FClock::now();
+
+		while (static_cast<int64_t>(JitterUs.size()) < NumFrames)
+		{
+			if (Run.bPoll)
+			{
+				// Stands in for a render thread checking once per ~0.5 ms of work
+				if (!Pacer.IsFrameDue())
+				{
+					std::this_thread::sleep_for(std::chrono::microseconds(500));
+					continue;
+				}
+			}
+			else
+			{
+				Pacer.WaitForNextFrame();
+			}
+
+			JitterUs.push_back(std::chrono::duration<double, std::micro>(Pacer.GetJitterStats().Last).count());
+		}
+
+		const double Elapsed = std::chrono::duration<double>(FSpoutFramePacer::FClock::now() - Start).count();
+		const FSpoutFramePacer::FJitterStats& Stats = Pacer.GetJitterStats();
+
+		std::sort(JitterUs.begin(), JitterUs.end());
+
+		std::printf("%-28s %7.3f fps  p50 %8.1f  p90 %8.1f  p99 %8.1f  p99.9 %8.1f  max %8.1f us  missed %lld\n",
+			Run.Name,
+			JitterUs.size() / Elapsed,
+			Percentile(JitterUs, 0.5),
+			Percentile(JitterUs, 0.9),
+			Percentile(JitterUs, 0.99),
+			Percentile(JitterUs, 0.999),
+			JitterUs.empty() ? 0.0 : JitterUs.back(),
+			static_cast<long long>(Stats.NumMissedFrames));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const double Seconds = argc > 1 ? std::atof(argv[1]) : 5.0;
+
+	const std::chrono::nanoseconds DefaultSpin = FSpoutFramePacer().SpinThreshold;
+
+	const FRun Runs[] =
+	{
+		{ "wait 60",               60,    1,    DefaultSpin,                   false },
+		{ "wait 60000/1001",       60000, 1001, DefaultSpin,                   false },
+		{ "wait 144",              144,   1,    DefaultSpin,                   false },
+		{ "wait 60, sleep only",   60,    1,    std::chrono::nanoseconds(0),   false },
+		{ "poll 60, 0.5 ms steps", 60,    1,    DefaultSpin,                   true },
+	};
+
+	std::printf("%.1f s per run, jitter is how late a frame was against its deadline\n", Seconds);
+
+	for (const FRun& Run : Runs)
+	{
+		Measure(Run, Seconds);
+	}
+
+	return 0;
+}
@@ -0,0 +1,210 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+// Load test of SpoutFrameRing in FSpoutSharedMemory across processes, the way the SharedMemory transport
+// uses them. Standard C++ and POSIX only and outside the module, so UnrealBuildTool does not compile it;
+// build and run it headless on Linux or macOS:
+//   g++ -std=c++17 -O2 -pthread -I../Spout2Media/Private SpoutFrameRingLoadTest.cpp ../Spout2Media/Private/SpoutSharedMemory.cpp -o SpoutFrameRingLoadTest
+//   ./SpoutFrameRingLoadTest [NumFrames] [NumReaders] [Width] [Height] [NumSlots]
+//
+// The writer process creates the ring and writes frames as fast as it can, every byte of a frame is the
+// low byte of its frame number. Reader processes open the ring by name and copy the latest frame like
+// receivers do. The test fails when a reader keeps a torn frame, frame numbers go backwards, or a frame's
+// description does not match what was written.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "SpoutFrameRing.h"
+#include "SpoutSharedMemory.h"
+
+namespace
+{
+	// Written by the readers into a small anonymous mapping shared with the writer
+	struct FReaderResult
+	{
+		uint64_t NumFrames;
+		uint64_t NumSkipped;
+		uint64_t NumOverruns;
+		uint64_t NumViolations;
+		double Seconds;
+	};
+
+	struct FConfig
+	{
+		uint64_t NumFrames = 3000;
+		int NumReaders = 4;
+		uint32_t Width = 1920;
+		uint32_t Height = 1080;
+		uint32_t NumSlots = 3;
+
+		uint32_t GetStride() const { return Width * 4; }
+		uint32_t GetFrameSize() const { return GetStride() * Height; }
+	};
+
+	bool IsIntact(const SpoutFrameRing::FFrameInfo& Info, const std::vector<uint8_t>& Frame, const FConfig& Config)
+	{
+		if (Info.Size != Config.GetFrameSize() || Info.Width != Config.Width || Info.Height != Config.Height
+			|| Info.Stride != Config.GetStride() || Info.TimestampNs != static_cast<int64_t>(Info.FrameNumber) * 1000)
+			return false;
+
+		// Every page and the last byte, a torn copy mixes frames on page boundaries
+		const uint8_t Expected = static_cast<uint8_t>(Info.FrameNumber);
+		for (size_t Offset = 0; Offset < Info.Size; Offset += 4093)
+		{
+			if (Frame[Offset] != Expected)
+				return false;
+		}
+		return Frame[Info.Size - 1] == Expected;
+	}
+
+	int RunReader(const std::string& RingName, const FConfig& Config, FReaderResult& Result)
+	{
+		FSpoutSharedMemory Memory;
+
+		// Waits for the writer like a receiver started first does
+		for (int Attempt = 0; !Memory.Open(RingName) || !SpoutFrameRing::IsValid(Memory.GetData(), Memory.GetSize()); Attempt++)
+		{
+			if (Attempt == 5000)
+			{
+				std::fprintf(stderr, "reader could not open %s\n", RingName.c_str());
+				return 1;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		SpoutFrameRing::FReader Reader(*static_cast<SpoutFrameRing::FRingHeader*>(Memory.GetData()));
+		std::vector<uint8_t> Frame(Config.GetFrameSize());
+		uint64_t LastFrame = 0;
+
+		const auto Start = std::chrono::steady_clock::now();
+
+		while (LastFrame < Config.NumFrames)
+		{
+			SpoutFrameRing::FFrameInfo Info;
+			const SpoutFrameRing::EReadResult ReadResult = Reader.ReadLatest(LastFrame, Info, Frame.data(), Frame.size());
+
+			if (ReadResult == SpoutFrameRing::EReadResult::Overrun)
+			{
+				Result.NumOverruns++;
+				continue;
+			}
+
+			if (ReadResult != SpoutFrameRing::EReadResult::Ok)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			if (Info.FrameNumber <= LastFrame || !IsIntact(Info, Frame, Config))
+			{
+				if (Result.NumViolations++ < 10)
+				{
+					std::fprintf(stderr, "FAIL: reader %d kept a bad frame %llu after %llu\n", static_cast<int>(getpid()),
+						static_cast<unsigned long long>(Info.FrameNumber), static_cast<unsigned long long>(LastFrame));
+				}
+			}
+
+			Result.NumSkipped += Info.FrameNumber - LastFrame - 1;
+			Result.NumFrames++;
+			LastFrame = Info.FrameNumber;
+		}
+
+		Result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		return 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	FConfig Config;
+	Config.NumFrames = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : Config.NumFrames;
+	Config.NumReaders = argc > 2 ? std::atoi(argv[2]) : Config.NumReaders;
+	Config.Width = argc > 3 ? static_cast<uint32_t>(std::atoi(argv[3])) : Config.Width;
+	Config.Height = argc > 4 ? static_cast<uint32_t>(std::atoi(argv[4])) : Config.Height;
+	Config.NumSlots = argc > 5 ? static_cast<uint32_t>(std::atoi(argv[5])) : Config.NumSlots;
+
+	const std::string RingName = "SpoutFrameRingLoadTest_" + std::to_string(getpid()) + "_SpoutFrames";
+
+	void* Shared = mmap(nullptr, sizeof(FReaderResult) * Config.NumReaders, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (Shared == MAP_FAILED)
+		return 1;
+
+	FReaderResult* Results = static_cast<FReaderResult*>(Shared);
+	std::memset(Results, 0, sizeof(FReaderResult) * Config.NumReaders);
+
+	FSpoutSharedMemory Memory;
+	if (!Memory.Create(RingName, SpoutFrameRing::GetRequiredSize(Config.NumSlots, Config.GetFrameSize())))
+	{
+		std::fprintf(stderr, "could not create %s\n", RingName.c_str());
+		return 1;
+	}
+
+	SpoutFrameRing::FWriter Writer(SpoutFrameRing::Initialize(Memory.GetData(), Config.NumSlots, Config.GetFrameSize()));
+
+	std::vector<pid_t> Readers;
+	for (int Reader = 0; Reader < Config.NumReaders; Reader++)
+	{
+		const pid_t Pid = fork();
+		if (Pid == 0)
+		{
+			// Maps the ring by name like another process would, not through the inherited mapping
+			_exit(RunReader(RingName, Config, Results[Reader]));
+		}
+		Readers.push_back(Pid);
+	}
+
+	const auto Start = std::chrono::steady_clock::now();
+
+	for (uint64_t Frame = 1; Frame <= Config.NumFrames; Frame++)
+	{
+		std::memset(Writer.BeginWrite(), static_cast<uint8_t>(Frame), Config.GetFrameSize());
+
+		SpoutFrameRing::FFrameInfo Info;
+		Info.TimestampNs = static_cast<int64_t>(Frame) * 1000;
+		Info.Width = Config.Width;
+		Info.Height = Config.Height;
+		Info.Stride = Config.GetStride();
+		Info.Size = Config.GetFrameSize();
+		Writer.EndWrite(Info);
+	}
+
+	const double WriteSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+	int NumFailedReaders = 0;
+	for (pid_t Pid : Readers)
+	{
+		int Status = 0;
+		waitpid(Pid, &Status, 0);
+		NumFailedReaders += !WIFEXITED(Status) || WEXITSTATUS(Status) != 0;
+	}
+
+	const double FrameMB = Config.GetFrameSize() / (1024.0 * 1024.0);
+	std::printf("%ux%u, %u slots, %d reader processes\n", Config.Width, Config.Height, Config.NumSlots, Config.NumReaders);
+	std::printf("writer: %llu frames, %.1f fps, %.0f MB/s\n", static_cast<unsigned long long>(Config.NumFrames),
+		Config.NumFrames / WriteSeconds, Config.NumFrames * FrameMB / WriteSeconds);
+
+	uint64_t Violations = 0;
+	for (int Reader = 0; Reader < Config.NumReaders; Reader++)
+	{
+		const FReaderResult& Result = Results[Reader];
+		std::printf("reader %d: %llu frames, %llu skipped, %llu overruns, %.1f fps\n", Reader,
+			static_cast<unsigned long long>(Result.NumFrames),
+			static_cast<unsigned long long>(Result.NumSkipped),
+			static_cast<unsigned long long>(Result.NumOverruns),
+			Result.Seconds > 0.0 ? Result.NumFrames / Result.Seconds : 0.0);
+		Violations += Result.NumViolations;
+	}
+
+	const bool bPassed = Violations == 0 && NumFailedReaders == 0;
+	std::printf("%s: %llu violations, %d readers failed\n", bPassed ? "PASS" : "FAIL", static_cast<unsigned long long>(Violations), NumFailedReaders);
+	return bPassed ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+// Wake latency and throughput of SpoutFrameSignal. Standard C++ plus mmap and outside the module, so
+// UnrealBuildTool does not compile it; build and run it headless on Linux:
+//   g++ -std=c++17 -O2 -pthread -I../Spout2Media/Private SpoutFrameSignalBenchmark.cpp -o SpoutFrameSignalBenchmark
+//   ./SpoutFrameSignalBenchmark [NumSignals]
+//
+// For 1, 8 and 32 waiter threads and both scopes, the layout in a shared mapping for EScope::Shared and on
+// the heap for EScope::Process:
+//  - latency: a signal every 500 us, waiters measure from just before Signal to waking up
+//  - throughput: signals back to back, waiters count how many they woke for and which they missed
+// Fails when a waiter's frame numbers go backwards or a frame number comes with another signal's sequence.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+
+#include "SpoutFrameSignal.h"
+
+namespace
+{
+	using FClock = std::chrono::steady_clock;
+	using SpoutFrameSignal::EScope;
+
+	struct FWaiterStats
+	{
+		uint64_t NumWakes = 0;
+		uint64_t NumMissed = 0;
+		uint64_t NumViolations = 0;
+		std::vector<double> LatencyUs;
+	};
+
+	int64_t NowNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>(FClock::now().time_since_epoch()).count(); }
+
+	double Percentile(const std::vector<double>& Sorted, double Fraction)
+	{
+		if (Sorted.empty())
+			return 0.0;
+
+		return Sorted[std::min(Sorted.size() - 1, static_cast<size_t>(Fraction * (Sorted.size() - 1) + 0.5))];
+	}
+
+	// Layout where the scope says it lives, a shared mapping like FSpoutSharedMemory or plain memory
+	std::shared_ptr<SpoutFrameSignal::FLayout> CreateLayout(EScope Scope)
+	{
+		if (Scope == EScope::Process)
+			return std::make_shared<SpoutFrameSignal::FLayout>();
+
+		void* Memory = mmap(nullptr, sizeof(SpoutFrameSignal::FLayout), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+		if (Memory == MAP_FAILED)
+			return nullptr;
+
+		return std::shared_ptr<SpoutFrameSignal::FLayout>(static_cast<SpoutFrameSignal::FLayout*>(Memory),
+			[](SpoutFrameSignal::FLayout* Layout) { munmap(Layout, sizeof(SpoutFrameSignal::FLayout)); });
+	}
+
+	// Returns the number of violations
+	uint64_t Run(int NumWaiters, EScope Scope, int NumSignals, bool bPaced)
+	{
+		std::shared_ptr<SpoutFrameSignal::FLayout> Layout = CreateLayout(Scope);
+		if (!Layout)
+			return 1;
+
+		Layout->Sequence.store(0);
+		Layout->NumWaiters.store(0);
+		Layout->FrameNumber.store(0);
+
+		std::atomic<int64_t> SignalledAtNs{0};
+		std::atomic<bool> bDone{false};
+		std::atomic<int> NumReady{0};
+		std::vector<FWaiterStats> Stats(NumWaiters);
+		std::vector<std::thread> Waiters;
+
+		for (FWaiterStats& WaiterStats : Stats)
+		{
+			Waiters.emplace_back([&, Scope]()
+			{
+				uint32_t Sequence = SpoutFrameSignal::GetSequence(*Layout);
+				uint64_t LastFrame = 0;
+				NumReady.fetch_add(1);
+
+				while (!bDone.load())
+				{
+					uint64_t Frame = 0;
+					if (!SpoutFrameSignal::Wait(*Layout, Sequence, std::chrono::milliseconds(50), Scope, &Frame) || Frame == 0)
+						continue;
+
+					if (bPaced)
+					{
+						WaiterStats.LatencyUs.push_back((NowNs() - SignalledAtNs.load()) / 1000.0);
+					}
+
+					// Frame N is signalled as the Nth signal, so it must come with its own sequence
+					if (Frame <= LastFrame || Frame != Sequence / 2)
+					{
+						WaiterStats.NumViolations++;
+					}
+
+					WaiterStats.NumMissed += LastFrame != 0 && Frame > LastFrame ? Frame - LastFrame - 1 : 0;
+					WaiterStats.NumWakes++;
+					LastFrame = Frame;
+				}
+			});
+		}
+
+		while (NumReady.load() < NumWaiters)
+		{
+			std::this_thread::yield();
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+		const FClock::time_point Start = FClock::now();
+		FClock::time_point Next = Start;
+
+		for (int Frame = 1; Frame <= NumSignals; Frame++)
+		{
+			if (bPaced)
+			{
+				Next += std::chrono::microseconds(500);
+				std::this_thread::sleep_until(Next);
+				SignalledAtNs.store(NowNs());
+			}
+
+			SpoutFrameSignal::Signal(*Layout, Frame, Scope);
+		}
+
+		const double Seconds = std::chrono::duration<double>(FClock::now() - Start).count();
+
+		// Frame 0 only wakes the waiters to see bDone
+		bDone.store(true);
+		SpoutFrameSignal::Signal(*Layout, 0, Scope);
+		for (std::thread& Waiter : Waiters)
+		{
+			Waiter.join();
+		}
+
+		uint64_t NumWakes = 0, NumMissed = 0, Violations = 0;
+		std::vector<double> LatencyUs;
+		for (const FWaiterStats& WaiterStats : Stats)
+		{
+			NumWakes += WaiterStats.NumWakes;
+			NumMissed += WaiterStats.NumMissed;
+			Violations += WaiterStats.NumViolations;
+			LatencyUs.insert(LatencyUs.end(), WaiterStats.LatencyUs.begin(), WaiterStats.LatencyUs.end());
+		}
+
+		const char* ScopeName = Scope == EScope::Process ? "process" : "shared";
+		if (bPaced)
+		{
+			std::sort(LatencyUs.begin(), LatencyUs.end());
+			std::printf("latency     %-7s %2d waiters: p50 %7.1f  p90 %7.1f  p99 %7.1f  max %8.1f us, %llu of %llu wakes missed\n",
+				ScopeName, NumWaiters, Percentile(LatencyUs, 0.5), Percentile(LatencyUs, 0.9), Percentile(LatencyUs, 0.99),
+				LatencyUs.empty() ? 0.0 : LatencyUs.back(),
+				static_cast<unsigned long long>(NumMissed), static_cast<unsigned long long>(NumMissed + NumWakes));
+		}
+		else
+		{
+			std::printf("throughput  %-7s %2d waiters: %9.0f signals/s, %5.1f%% of signals seen per waiter\n",
+				ScopeName, NumWaiters, NumSignals / Seconds, 100.0 * NumWakes / (double(NumSignals) * NumWaiters));
+		}
+
+		return Violations;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int NumSignals = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+	uint64_t Violations = 0;
+	for (bool bPaced : { true, false })
+	{
+		for (int NumWaiters : { 1, 8, 32 })
+		{
+			for (EScope Scope : { EScope::Process, EScope::Shared })
+			{
+				Violations += Run(NumWaiters, Scope, bPaced ? NumSignals : NumSignals * 100, bPaced);
+			}
+		}
+	}
+
+	std::printf("%s: %llu violations\n", Violations == 0 ? "PASS" : "FAIL", static_cast<unsigned long long>(Violations));
+	return Violations == 0 ? 0 : 1;
+}
@@ -0,0 +1,208 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+// Throughput and latency of SpoutTransport::FLoopbackTransport. Standard C++ only and outside the module, so
+// UnrealBuildTool does not compile it; build and run it headless on any platform:
+//   g++ -std=c++17 -O2 -pthread -I../Spout2Media/Private SpoutLoopbackTransportBenchmark.cpp -o SpoutLoopbackTransportBenchmark
+//   ./SpoutLoopbackTransportBenchmark [NumReceivers] [Width] [Height] [Seconds]
+//
+// Two runs, each with one sender thread and NumReceivers receiver threads polling AcquireLatest:
+//  - throughput: the sender publishes as fast as it can, receivers read one byte per page of each frame
+//  - latency: the sender is paced at 60 fps, receivers measure from EndFrame to getting the frame
+// Both fail when a receiver gets a frame whose contents do not match its number, or numbers go backwards.
+//
+// Only the CPU transport is covered. The shared texture path goes through the D3D receiver and sender
+// contexts of the Win64 module and is not part of this.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "SpoutTransport.h"
+
+namespace
+{
+	using FClock = std::chrono::steady_clock;
+
+	struct FConfig
+	{
+		int NumReceivers = 2;
+		uint32_t Width = 1920;
+		uint32_t Height = 1080;
+		double Seconds = 3.0;
+
+		uint32_t GetFrameSize() const { return Width * Height * 4; }
+	};
+
+	struct FReceiverStats
+	{
+		uint64_t NumFrames = 0;
+		uint64_t NumSkipped = 0;
+		uint64_t NumViolations = 0;
+		std::vector<double> LatencyUs;
+	};
+
+	struct FSenderStats
+	{
+		uint64_t NumFrames = 0;
+		uint64_t NumPoolFull = 0;
+		double Seconds = 0.0;
+	};
+
+	int64_t NowNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>(FClock::now().time_since_epoch()).count(); }
+
+	void RunReceiver(SpoutTransport::ITransport& Transport, const std::atomic<bool>& bDone, FReceiverStats& Stats)
+	{
+		std::unique_ptr<SpoutTransport::IReceiver> Receiver = Transport.CreateReceiver("SpoutLoopbackTransportBenchmark");
+		uint64_t LastFrame = 0;
+
+		while (!bDone.load())
+		{
+			const SpoutTransport::FFramePtr Frame = Receiver->AcquireLatest(LastFrame);
+			if (!Frame)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			const int64_t LatencyNs = NowNs() - Frame->Info.TimestampNs;
+
+			// Touches every page like a copy out would, the frame must not change while it is held
+			const uint8_t Expected = static_cast<uint8_t>(Frame->Info.FrameNumber);
+			bool bIntact = Frame->Info.FrameNumber > LastFrame && Frame->Info.Size == Frame->Data.size();
+			for (size_t Offset = 0; bIntact && Offset < Frame->Info.Size; Offset += 4096)
+			{
+				bIntact = Frame->Data[Offset] == Expected;
+			}
+
+			if (!bIntact)
+			{
+				Stats.NumViolations++;
+			}
+
+			Stats.LatencyUs.push_back(LatencyNs / 1000.0);
+			Stats.NumSkipped += LastFrame != 0 ? Frame->Info.FrameNumber - LastFrame - 1 : 0;
+			Stats.NumFrames++;
+			LastFrame = Frame->Info.FrameNumber;
+		}
+	}
+
+	void RunSender(SpoutTransport::ISender& Sender, const FConfig& Config, int64_t FramePeriodNs, FSenderStats& Stats)
+	{
+		const FClock::time_point Start = FClock::now();
+		const FClock::time_point End = Start + std::chrono::duration_cast<FClock::duration>(std::chrono::duration<double>(Config.Seconds));
+		FClock::time_point Next = Start;
+
+		// Frame numbers are counted by the transport, frames the pool cannot take are not numbered
+		uint64_t FrameNumber = 0;
+
+		while (FClock::now() < End)
+		{
+			if (FramePeriodNs > 0)
+			{
+				Next += std::chrono::nanoseconds(FramePeriodNs);
+				std::this_thread::sleep_until(Next);
+			}
+
+			uint8_t* Data = Sender.BeginFrame(Config.GetFrameSize());
+			if (!Data)
+			{
+				Stats.NumPoolFull++;
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::memset(Data, static_cast<uint8_t>(FrameNumber + 1), Config.GetFrameSize());
+
+			SpoutTransport::FFrameInfo Info;
+			Info.Width = Config.Width;
+			Info.Height = Config.Height;
+			Info.Stride = Config.Width * 4;
+			Info.Size = Config.GetFrameSize();
+			Info.TimestampNs = NowNs();
+			FrameNumber = Sender.EndFrame(Info);
+			Stats.NumFrames++;
+		}
+
+		Stats.Seconds = std::chrono::duration<double>(FClock::now() - Start).count();
+	}
+
+	double Percentile(const std::vector<double>& Sorted, double Fraction)
+	{
+		if (Sorted.empty())
+			return 0.0;
+
+		return Sorted[std::min(Sorted.size() - 1, static_cast<size_t>(Fraction * (Sorted.size() - 1) + 0.5))];
+	}
+
+	// Returns the number of violations
+	uint64_t Run(const char* Name, const FConfig& Config, int64_t FramePeriodNs)
+	{
+		SpoutTransport::FLoopbackTransport Transport;
+		std::unique_ptr<SpoutTransport::ISender> Sender = Transport.CreateSender("SpoutLoopbackTransportBenchmark", Config.GetFrameSize());
+
+		std::atomic<bool> bDone{false};
+		std::vector<FReceiverStats> ReceiverStats(Config.NumReceivers);
+		std::vector<std::thread> Receivers;
+
+		for (FReceiverStats& Stats : ReceiverStats)
+		{
+			Receivers.emplace_back(RunReceiver, std::ref(Transport), std::cref(bDone), std::ref(Stats));
+		}
+
+		FSenderStats SenderStats;
+		RunSender(*Sender, Config, FramePeriodNs, SenderStats);
+
+		bDone.store(true);
+		for (std::thread& Receiver : Receivers)
+		{
+			Receiver.join();
+		}
+
+		const double FrameMB = Config.GetFrameSize() / (1024.0 * 1024.0);
+		std::printf("%s: sender %.0f fps (%.0f MB/s), %llu times the pool was full\n", Name,
+			SenderStats.NumFrames / SenderStats.Seconds, SenderStats.NumFrames * FrameMB / SenderStats.Seconds,
+			static_cast<unsigned long long>(SenderStats.NumPoolFull));
+
+		uint64_t Violations = 0;
+		std::vector<double> LatencyUs;
+
+		for (size_t Index = 0; Index < ReceiverStats.size(); Index++)
+		{
+			const FReceiverStats& Stats = ReceiverStats[Index];
+			std::printf("  receiver %zu: %llu frames, %llu skipped\n", Index,
+				static_cast<unsigned long long>(Stats.NumFrames), static_cast<unsigned long long>(Stats.NumSkipped));
+
+			Violations += Stats.NumViolations;
+			LatencyUs.insert(LatencyUs.end(), Stats.LatencyUs.begin(), Stats.LatencyUs.end());
+		}
+
+		std::sort(LatencyUs.begin(), LatencyUs.end());
+		std::printf("  EndFrame to acquire: p50 %.1f  p90 %.1f  p99 %.1f  max %.1f us\n",
+			Percentile(LatencyUs, 0.5), Percentile(LatencyUs, 0.9), Percentile(LatencyUs, 0.99),
+			LatencyUs.empty() ? 0.0 : LatencyUs.back());
+
+		return Violations;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	FConfig Config;
+	Config.NumReceivers = argc > 1 ? std::atoi(argv[1]) : Config.NumReceivers;
+	Config.Width = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : Config.Width;
+	Config.Height = argc > 3 ? static_cast<uint32_t>(std::atoi(argv[3])) : Config.Height;
+	Config.Seconds = argc > 4 ? std::atof(argv[4]) : Config.Seconds;
+
+	std::printf("%ux%u, %d receivers, %.1f s per run\n", Config.Width, Config.Height, Config.NumReceivers, Config.Seconds);
+
+	uint64_t Violations = Run("throughput", Config, 0);
+	Violations += Run("latency at 60 fps", Config, 1000000000 / 60);
+
+	std::printf("%s: %llu violations\n", Violations == 0 ? "PASS" : "FAIL", static_cast<unsigned long long>(Violations));
+	return Violations == 0 ? 0 : 1;
+}
@@ -0,0 +1,261 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+// Registers and looks up many senders through SpoutSenderDirectory in FSpoutSharedMemory, across two
+// processes like senders and receivers. Standard C++ and POSIX only and outside the module, so
+// UnrealBuildTool does not compile it; build and run it headless on Linux or macOS:
+//   g++ -std=c++17 -O2 -pthread -I../Spout2Media/Private SpoutSenderDirectoryBenchmark.cpp ../Spout2Media/Private/SpoutSharedMemory.cpp -o SpoutSenderDirectoryBenchmark
+//   ./SpoutSenderDirectoryBenchmark [NumSenders]
+//
+// A sender process registers NumSenders senders with a frame rate suffix. The receiver process then
+// - looks each one up by its name without the suffix,
+// - checks the generations it resolved, as FSpoutSenderDirectoryLookup does every update,
+// - compares with a linear scan over every name, like a plain list of sender names,
+// - waits on the directory signal while the sender resizes one sender and unregisters another.
+// Fails when a lookup misses, or the generations do not point out exactly the two changed senders.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "SpoutSenderDirectory.h"
+#include "SpoutSharedMemory.h"
+
+namespace
+{
+	using FClock = std::chrono::steady_clock;
+
+	// Hand-off between the two processes, in an anonymous mapping both inherit
+	struct FControl
+	{
+		std::atomic<uint32_t> bRegistered;
+		std::atomic<uint32_t> bLookupsDone;
+		std::atomic<int64_t> ChangedAtNs[2];
+		double RegisterUs;
+	};
+
+	int64_t NowNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>(FClock::now().time_since_epoch()).count(); }
+
+	void MakeInfo(int Index, uint32_t Width, uint32_t Height, SpoutSenderDirectory::FSenderInfo& OutInfo)
+	{
+		std::snprintf(OutInfo.Name, sizeof(OutInfo.Name), "Sender %d|FPS=60/1", Index);
+		OutInfo.Width = Width;
+		OutInfo.Height = Height;
+		OutInfo.Format = 87;
+		OutInfo.FrameRateNumerator = 60;
+		OutInfo.FrameRateDenominator = 1;
+	}
+
+	template<typename FPredicate>
+	bool WaitFor(FPredicate&& Predicate)
+	{
+		for (int Attempt = 0; Attempt < 10000; Attempt++)
+		{
+			if (Predicate())
+				return true;
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return false;
+	}
+
+	int RunSender(const std::string& DirectoryName, int NumSenders, FControl& Control)
+	{
+		FSpoutSharedMemory Memory;
+		if (!Memory.Open(DirectoryName) || Memory.GetSize() < sizeof(SpoutSenderDirectory::FLayout))
+			return 1;
+
+		SpoutSenderDirectory::FLayout& Layout = *static_cast<SpoutSenderDirectory::FLayout*>(Memory.GetData());
+		std::vector<uint32_t> Slots;
+
+		const FClock::time_point Start = FClock::now();
+		for (int Index = 0; Index < NumSenders; Index++)
+		{
+			SpoutSenderDirectory::FSenderInfo Info;
+			MakeInfo(Index, 1920, 1080, Info);
+			Slots.push_back(SpoutSenderDirectory::Register(Layout, Info));
+		}
+		Control.RegisterUs = std::chrono::duration<double, std::micro>(FClock::now() - Start).count();
+		Control.bRegistered.store(1);
+
+		if (!WaitFor([&]() { return Control.bLookupsDone.load() != 0; }))
+			return 1;
+
+		// One resize and one removal, each a directory change the receiver waits for
+		SpoutSenderDirectory::FSenderInfo Info;
+		MakeInfo(NumSenders / 2, 3840, 2160, Info);
+		Control.ChangedAtNs[0].store(NowNs());
+		SpoutSenderDirectory::Write(Layout, Slots[NumSenders / 2], Info);
+
+		// Lets the receiver take the first change before the second one
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+		Control.ChangedAtNs[1].store(NowNs());
+		SpoutSenderDirectory::Unregister(Layout, Slots[NumSenders * 7 / 10]);
+		return 0;
+	}
+
+	double Percentile(const std::vector<double>& Sorted, double Fraction)
+	{
+		if (Sorted.empty())
+			return 0.0;
+
+		return Sorted[std::min(Sorted.size() - 1, static_cast<size_t>(Fraction * (Sorted.size() - 1) + 0.5))];
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int NumSenders = std::min(argc > 1 ? std::atoi(argv[1]) : 1000, int(SpoutSenderDirectory::NumSlots) / 2);
+	const std::string DirectoryName = "SpoutSenderDirectoryBenchmark_" + std::to_string(getpid());
+
+	void* Shared = mmap(nullptr, sizeof(FControl), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (Shared == MAP_FAILED)
+		return 1;
+
+	FControl& Control = *new (Shared) FControl();
+
+	// Zero-filled like the shared memory the plugin creates, the directory needs no initialization
+	FSpoutSharedMemory Memory;
+	if (!Memory.Create(DirectoryName, sizeof(SpoutSenderDirectory::FLayout)))
+	{
+		std::fprintf(stderr, "could not create %s\n", DirectoryName.c_str());
+		return 1;
+	}
+
+	SpoutSenderDirectory::FLayout& Layout = *static_cast<SpoutSenderDirectory::FLayout*>(Memory.GetData());
+	std::printf("directory: %zu KB, %u slots, %d senders\n", sizeof(SpoutSenderDirectory::FLayout) / 1024, SpoutSenderDirectory::NumSlots, NumSenders);
+
+	const pid_t Sender = fork();
+	if (Sender == 0)
+	{
+		_exit(RunSender(DirectoryName, NumSenders, Control));
+	}
+
+	int NumFailures = 0;
+	if (!WaitFor([&]() { return Control.bRegistered.load() != 0; }))
+	{
+		std::fprintf(stderr, "sender process did not register\n");
+		kill(Sender, SIGKILL);
+		waitpid(Sender, nullptr, 0);
+		return 1;
+	}
+
+	std::printf("register: %.0f us for all, %.2f us each, %u live\n", Control.RegisterUs, Control.RegisterUs / NumSenders, Layout.NumSenders.load());
+
+	// Lookups by the name receivers are configured with, without the frame rate
+	std::vector<uint32_t> Slots(NumSenders);
+	std::vector<uint32_t> Generations(NumSenders);
+	std::vector<double> LookupNs;
+	char Name[64];
+
+	for (int Repeat = 0; Repeat < 5; Repeat++)
+	{
+		for (int Index = 0; Index < NumSenders; Index++)
+		{
+			std::snprintf(Name, sizeof(Name), "Sender %d", Index);
+
+			SpoutSenderDirectory::FSenderInfo Info;
+			const FClock::time_point Start = FClock::now();
+			Slots[Index] = SpoutSenderDirectory::Find(Layout, Name, Info, &Generations[Index]);
+			LookupNs.push_back(std::chrono::duration<double, std::nano>(FClock::now() - Start).count());
+
+			if (Slots[Index] == SpoutSenderDirectory::NoSlot || !SpoutSenderDirectory::IsSameSender(Info.Name, Name))
+			{
+				if (NumFailures++ < 10)
+				{
+					std::fprintf(stderr, "FAIL: lookup of %s missed\n", Name);
+				}
+			}
+		}
+	}
+
+	std::sort(LookupNs.begin(), LookupNs.end());
+	std::printf("lookup by name: p50 %.0f ns, p99 %.0f ns, max %.0f ns\n", Percentile(LookupNs, 0.5), Percentile(LookupNs, 0.99), LookupNs.back());
+
+	const int NumChecks = 1000;
+	FClock::time_point Start = FClock::now();
+	uint32_t NumChanged = 0;
+	for (int Repeat = 0; Repeat < NumChecks; Repeat++)
+	{
+		for (int Index = 0; Index < NumSenders; Index++)
+		{
+			NumChanged += SpoutSenderDirectory::GetGeneration(Layout, Slots[Index]) != Generations[Index];
+		}
+	}
+	std::printf("generation check: %.1f ns per sender, %u changed\n",
+		std::chrono::duration<double, std::nano>(FClock::now() - Start).count() / (double(NumChecks) * NumSenders), NumChanged);
+
+	// What looking senders up in a plain name list costs
+	std::vector<std::string> Names;
+	SpoutSenderDirectory::ForEachSender(Layout, [&Names](uint32_t, const SpoutSenderDirectory::FSenderInfo& Info) { Names.push_back(Info.Name); });
+
+	Start = FClock::now();
+	size_t NumFound = 0;
+	for (int Index = 0; Index < NumSenders; Index++)
+	{
+		std::snprintf(Name, sizeof(Name), "Sender %d|FPS=60/1", Index);
+		NumFound += std::find(Names.begin(), Names.end(), Name) != Names.end();
+	}
+	std::printf("linear name scan: %.0f ns per lookup, %zu found\n",
+		std::chrono::duration<double, std::nano>(FClock::now() - Start).count() / NumSenders, NumFound);
+
+	// The resize and the removal, each wakes the directory signal
+	uint32_t DirectoryGeneration = SpoutSenderDirectory::GetDirectoryGeneration(Layout);
+	Control.bLookupsDone.store(1);
+
+	for (int Change = 0; Change < 2; Change++)
+	{
+		uint64_t ChangedSlot = 0;
+		if (!SpoutFrameSignal::Wait(Layout.Changed, DirectoryGeneration, std::chrono::seconds(5), SpoutFrameSignal::EScope::Shared, &ChangedSlot))
+		{
+			std::fprintf(stderr, "FAIL: no directory change %d\n", Change);
+			NumFailures++;
+			break;
+		}
+
+		std::printf("directory change %d: woke %.1f us after it, slot %llu\n", Change,
+			(NowNs() - Control.ChangedAtNs[Change].load()) / 1000.0, static_cast<unsigned long long>(ChangedSlot));
+	}
+
+	int Status = 0;
+	waitpid(Sender, &Status, 0);
+	if (!WIFEXITED(Status) || WEXITSTATUS(Status) != 0)
+	{
+		std::fprintf(stderr, "FAIL: sender process failed\n");
+		NumFailures++;
+	}
+
+	// Exactly the resized and the removed sender changed
+	for (int Index = 0; Index < NumSenders; Index++)
+	{
+		const bool bChanged = SpoutSenderDirectory::GetGeneration(Layout, Slots[Index]) != Generations[Index];
+		const bool bExpected = Index == NumSenders / 2 || Index == NumSenders * 7 / 10;
+		if (bChanged != bExpected)
+		{
+			std::fprintf(stderr, "FAIL: sender %d %s\n", Index, bChanged ? "changed" : "did not change");
+			NumFailures++;
+		}
+	}
+
+	SpoutSenderDirectory::FSenderInfo Resized;
+	if (!SpoutSenderDirectory::Read(Layout, Slots[NumSenders / 2], Resized) || Resized.Width != 3840
+		|| SpoutSenderDirectory::Read(Layout, Slots[NumSenders * 7 / 10], Resized))
+	{
+		std::fprintf(stderr, "FAIL: changed senders read back wrong\n");
+		NumFailures++;
+	}
+
+	std::printf("%s: %d failures\n", NumFailures == 0 ? "PASS" : "FAIL", NumFailures);
+	return NumFailures == 0 ? 0 : 1;
+}